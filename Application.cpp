@@ -4,6 +4,8 @@
 #include "classes/Checkers.h"
 #include "classes/Othello.h"
 #include "classes/Chess.h"
+#include "classes/Profiler.h"
+#include "classes/TextureCache.h"
 
 namespace ClassGame {
         //
@@ -13,6 +15,19 @@ namespace ClassGame {
         bool gameOver = false;
         int gameWinner = -1;
 
+        // where the chess AI keeps what it learned when "Keep chess AI table" is ticked
+        static const char *kChessTableFile = "chess_ai.tt";
+        static bool keepChessTable = false;
+
+        // frames drawn after things go quiet, so imgui's hover and focus changes catch up with the last input
+        static const int kSettleFrames = 3;
+        static int quietFrames = 0;
+
+        // the board as text for the settings window, built for board version boardTextVersion
+        static unsigned int boardTextVersion = 0;
+        static std::vector<std::string> boardTextRows;
+        static std::string boardTextState;
+
         //
         // game starting point
         // this is called by the main render loop in main.cpp
@@ -20,6 +35,19 @@ namespace ClassGame {
         void GameStartUp() 
         {
             game = nullptr;
+            // the piece images decode in the background while the first frames draw, RenderGame uploads them when they're done
+            TextureCache::startLoading();
+        }
+
+        //
+        // stopping the game lets it save anything it keeps between runs
+        //
+        void GameShutDown()
+        {
+            if (game) {
+                game->stopGame();
+            }
+            TextureCache::stopLoading();
         }
 
         //
@@ -28,64 +56,128 @@ namespace ClassGame {
         //
         void RenderGame() 
         {
-                ImGui::DockSpaceOverViewport();
+                // the frame zone closes here, so it is finished before the overlay draws and the frame ends
+                {
+                    PROFILE_ZONE(ZoneFrame);
+                    ImGui::DockSpaceOverViewport();
 
-                //ImGui::ShowDemoWindow();
+                    // one upload for every piece image, as soon as the workers have them all
+                    if (TextureCache::decoded()) {
+                        TextureCache::buildAtlas();
+                    }
 
-                ImGui::Begin("Settings");
+                    //ImGui::ShowDemoWindow();
 
-                if (gameOver) {
-                    ImGui::Text("Game Over!");
-                    ImGui::Text("Winner: %d", gameWinner);
-                    if (ImGui::Button("Reset Game")) {
-                        game->stopGame();
-                        game->setUpBoard();
-                        gameOver = false;
-                        gameWinner = -1;
-                    }
-                }
-                if (!game) {
-                    if (ImGui::Button("Start Tic-Tac-Toe")) {
-                        game = new TicTacToe();
-                        game->setUpBoard();
-                    }
-                    if (ImGui::Button("Start Checkers")) {
-                        game = new Checkers();
-                        game->setUpBoard();
-                    }
-                    if (ImGui::Button("Start Othello")) {
-                        game = new Othello();
-                        game->setUpBoard();
+                    ImGui::Begin("Settings");
+
+                    if (gameOver) {
+                        ImGui::Text("Game Over!");
+                        ImGui::Text("Winner: %d", gameWinner);
+                        if (ImGui::Button("Reset Game")) {
+                            game->stopGame();
+                            game->setUpBoard();
+                            gameOver = false;
+                            gameWinner = -1;
+                        }
                     }
-                    if (ImGui::Button("Start Chess")) {
-                        game = new Chess();
-                        game->setUpBoard();
-                        game->setAIPlayer(1);
+                    if (!game) {
+                        // the pieces come out of the atlas, so no game starts until it can be built without waiting
+                        ImGui::BeginDisabled(!TextureCache::decoded());
+                        if (ImGui::Button("Start Tic-Tac-Toe")) {
+                            game = new TicTacToe();
+                            game->setUpBoard();
+                        }
+                        if (ImGui::Button("Start Gomoku")) {
+                            game = new TicTacToe(15, 15, 5);
+                            game->setUpBoard();
+                        }
+                        if (ImGui::Button("Start Checkers")) {
+                            game = new Checkers();
+                            game->setUpBoard();
+                        }
+                        if (ImGui::Button("Start Othello")) {
+                            game = new Othello();
+                            game->setUpBoard();
+                        }
+                        if (ImGui::Button("Start Chess")) {
+                            Chess *chess = new Chess();
+                            if (keepChessTable) {
+                                chess->setTableFile(kChessTableFile);
+                            }
+                            game = chess;
+                            game->setUpBoard();
+                            game->setAIPlayer(1);
+                        }
+                        ImGui::EndDisabled();
+                        ImGui::SameLine();
+                        ImGui::Checkbox("Keep chess AI table", &keepChessTable);
+                    } else {
+                        ImGui::Text("Current Player Number: %d", game->getCurrentPlayer()->playerNumber());
+                        game->drawAIStatus();
+
+                        // step through the turn history, against the AI undo and redo stop on the human's turns
+                        bool skipAITurns = game->gameHasAI() && !game->_gameOptions.AIvsAI;
+                        bool historyChanged = false;
+                        if (ImGui::Button("Undo") && game->canUndoTurn()) {
+                            do {
+                                game->undoTurn();
+                            } while (skipAITurns && game->canUndoTurn() && game->getCurrentPlayer()->isAIPlayer());
+                            historyChanged = true;
+                        }
+                        ImGui::SameLine();
+                        if (ImGui::Button("Redo") && game->canRedoTurn()) {
+                            do {
+                                game->redoTurn();
+                            } while (skipAITurns && game->canRedoTurn() && game->getCurrentPlayer()->isAIPlayer());
+                            historyChanged = true;
+                        }
+                        int turn = game->moveLog().current();
+                        if (ImGui::SliderInt("Turn", &turn, 0, game->moveLog().turns())) {
+                            game->seekTurn(turn);
+                            historyChanged = true;
+                        }
+                        if (historyChanged) {
+                            gameOver = false;
+                            gameWinner = -1;
+                            EndOfTurn();
+                        }
+
+                        // the board text is only rebuilt when the board changes, not every frame
+                        if (boardTextVersion != game->boardVersion()) {
+                            std::string stateString = game->stateString();
+                            int stride = game->_gameOptions.rowX;
+                            int height = game->_gameOptions.rowY;
+
+                            boardTextRows.clear();
+                            for (int y = height; y >= 0; y--) {
+                                boardTextRows.push_back(stateString.substr(y * stride, stride));
+                            }
+                            reverse(stateString.begin(), stateString.end());
+                            boardTextState = "Current Board State: " + stateString;
+                            boardTextVersion = game->boardVersion();
+                        }
+                        for (const std::string &row : boardTextRows) {
+                            ImGui::TextUnformatted(row.c_str());
+                        }
+                        ImGui::TextUnformatted(boardTextState.c_str());
                     }
-                } else {
-                    ImGui::Text("Current Player Number: %d", game->getCurrentPlayer()->playerNumber());
-                    std::string stateString = game->stateString();
-                    int stride = game->_gameOptions.rowX;
-                    int height = game->_gameOptions.rowY;
-
-                for (int y = height; y >= 0; y--) {
-                    ImGui::Text("%s", stateString.substr(y * stride, stride).c_str());
-                }
-                    reverse(stateString.begin(), stateString.end());
-                    ImGui::Text("Current Board State: %s", stateString.c_str());
-                }
-                ImGui::End();
+                    ImGui::End();
 
-                ImGui::Begin("GameWindow");
+                    ImGui::Begin("GameWindow");
 
-                if (game) {
-                    if (game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
-                    {
-                        game->updateAI();
+                    if (game) {
+                        if (game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
+                        {
+                            PROFILE_ZONE(ZoneUpdateAI);
+                            game->updateAI();
+                        }
+                        game->drawFrame();
                     }
-                    game->drawFrame();
+                    ImGui::End();
                 }
-                ImGui::End();
+
+                PROFILE_DRAW_OVERLAY();
+                PROFILE_END_FRAME();
         }
 
         //
@@ -105,4 +197,41 @@ namespace ClassGame {
                 gameWinner = -1;
             }
         }
+
+        //
+        // the board only needs redrawing every frame while it's moving by itself:
+        // a piece animating or being dragged, or the AI thinking, which happens a slice per frame from RenderGame
+        //
+        static bool needsEveryFrame()
+        {
+            if (ImGui::IsAnyMouseDown()) {
+                return true;
+            }
+            // keep drawing until the piece images are in, so the upload isn't left waiting on input
+            if (!TextureCache::decoded()) {
+                return true;
+            }
+            if (!game) {
+                return false;
+            }
+            if (game->isAnimating()) {
+                return true;
+            }
+            return !gameOver && game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI);
+        }
+
+        bool IdleUntilInput()
+        {
+            if (needsEveryFrame()) {
+                quietFrames = 0;
+                return false;
+            }
+            if (quietFrames < kSettleFrames) {
+                quietFrames++;
+                return false;
+            }
+            // whatever wakes the loop up gets its settle frames too
+            quietFrames = 0;
+            return true;
+        }
 }
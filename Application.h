@@ -2,6 +2,10 @@
 
 namespace ClassGame {
     void GameStartUp();
+    // the window is closing, called before the backends shut down
+    void GameShutDown();
     void RenderGame();
     void EndOfTurn();
+    // true when the main loop can sleep until the next input, nothing on screen changes before then
+    bool IdleUntilInput();
 }
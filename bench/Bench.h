@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+//
+// minimal timing harness for the engine benchmarks
+// each benchmark body is run in batches sized so a batch takes at least _minBatchMs,
+// the reported figure is the median ns/op over several batches.
+// results are written one JSON object per line so runs can be diffed against a stored baseline.
+//
+namespace Bench
+{
+    // keep the optimizer from discarding a value that is otherwise unused
+    template <typename T>
+    inline void doNotOptimize(const T &value)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        static const volatile void *sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "g"(&value) : "memory");
+#endif
+    }
+
+    struct Result
+    {
+        std::string name;
+        uint64_t iterations;
+        double nsPerOp;
+        double minNsPerOp;
+    };
+
+    class Runner
+    {
+    public:
+        Runner(double minBatchMs = 2.0, int batches = 9) : _minBatchMs(minBatchMs), _batches(batches) {}
+
+        void setFilter(const std::string &filter) { _filter = filter; }
+
+        template <typename Func>
+        void run(const std::string &name, Func body)
+        {
+            if (!_filter.empty() && name.find(_filter) == std::string::npos)
+            {
+                return;
+            }
+
+            // grow the batch until it is long enough to time reliably
+            uint64_t batch = 1;
+            while (timeBatch(body, batch) < _minBatchMs * 1.0e6 && batch < (1ull << 32))
+            {
+                batch *= 2;
+            }
+
+            std::vector<double> samples;
+            samples.reserve(_batches);
+            for (int i = 0; i < _batches; i++)
+            {
+                samples.push_back(timeBatch(body, batch) / (double)batch);
+            }
+            std::sort(samples.begin(), samples.end());
+
+            Result result{name, batch * _batches, samples[samples.size() / 2], samples.front()};
+            _results.push_back(result);
+            std::printf("%-40s %12.1f ns/op  (min %.1f, %llu iterations)\n", name.c_str(), result.nsPerOp, result.minNsPerOp,
+                        (unsigned long long)result.iterations);
+        }
+
+        bool writeResults(const std::string &path) const
+        {
+            std::ofstream out(path);
+            if (!out)
+            {
+                std::cout << "Failed to write benchmark results: " << path << std::endl;
+                return false;
+            }
+            for (const Result &result : _results)
+            {
+                out << "{\"name\": \"" << result.name << "\", \"ns_per_op\": " << result.nsPerOp
+                    << ", \"min_ns_per_op\": " << result.minNsPerOp << ", \"iterations\": " << result.iterations << "}\n";
+            }
+            return true;
+        }
+
+        // print the change against a results file from an earlier run
+        bool compareWith(const std::string &path) const
+        {
+            std::ifstream in(path);
+            if (!in)
+            {
+                std::cout << "Failed to read benchmark baseline: " << path << std::endl;
+                return false;
+            }
+            std::unordered_map<std::string, double> baseline;
+            std::string line;
+            while (std::getline(in, line))
+            {
+                std::string name;
+                double nsPerOp = 0.0;
+                if (parseLine(line, name, nsPerOp))
+                {
+                    baseline[name] = nsPerOp;
+                }
+            }
+
+            std::printf("\n%-40s %12s %12s %9s\n", "benchmark", "baseline", "current", "change");
+            for (const Result &result : _results)
+            {
+                auto it = baseline.find(result.name);
+                if (it == baseline.end() || it->second <= 0.0)
+                {
+                    std::printf("%-40s %12s %12.1f %9s\n", result.name.c_str(), "-", result.nsPerOp, "new");
+                    continue;
+                }
+                double change = (result.nsPerOp - it->second) / it->second * 100.0;
+                std::printf("%-40s %12.1f %12.1f %+8.1f%%\n", result.name.c_str(), it->second, result.nsPerOp, change);
+            }
+            return true;
+        }
+
+    private:
+        template <typename Func>
+        double timeBatch(Func &body, uint64_t batch)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < batch; i++)
+            {
+                body();
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+
+        // reads back the lines produced by writeResults
+        static bool parseLine(const std::string &line, std::string &name, double &nsPerOp)
+        {
+            const std::string nameKey = "\"name\": \"";
+            const std::string nsKey = "\"ns_per_op\": ";
+            size_t nameStart = line.find(nameKey);
+            size_t nsStart = line.find(nsKey);
+            if (nameStart == std::string::npos || nsStart == std::string::npos)
+            {
+                return false;
+            }
+            nameStart += nameKey.size();
+            size_t nameEnd = line.find('"', nameStart);
+            if (nameEnd == std::string::npos)
+            {
+                return false;
+            }
+            name = line.substr(nameStart, nameEnd - nameStart);
+            std::istringstream value(line.substr(nsStart + nsKey.size()));
+            return (bool)(value >> nsPerOp);
+        }
+
+        double _minBatchMs;
+        int _batches;
+        std::string _filter;
+        std::vector<Result> _results;
+    };
+}
@@ -0,0 +1,361 @@
+#include "Bench.h"
+#include "../classes/Chess.h"
+#include "../classes/Othello.h"
+#include "../classes/CheckersBoard.h"
+#include "../classes/MNKBoard.h"
+#include "../classes/Grid.h"
+#include "../classes/TicTacToe.h"
+#include "../imgui/imgui.h"
+#include <cstring>
+
+//
+// engine microbenchmarks
+// usage: bench [--out results.jsonl] [--baseline baseline.jsonl] [--filter name] [--min-batch-ms 2]
+//
+
+static const char *kStartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR";
+static const char *kMiddlegameFEN = "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP2BPPP/R2QKB1R";
+
+static void benchChess(Bench::Runner &runner)
+{
+    Chess chess;
+    chess.setUpBoard();
+
+    chess.FENtoBoard(kMiddlegameFEN);
+    std::string state = chess.stateString();
+
+    runner.run("chess/generateMoves", [&] {
+        auto moves = ChessBoard::generateMoves(state.c_str(), 'W');
+        Bench::doNotOptimize(moves);
+    });
+
+    auto moves = ChessBoard::generateMoves(state.c_str(), 'W');
+    runner.run("chess/tryMove+undoMove", [&] {
+        for (auto &move : moves)
+        {
+            char captured = state[move.to];
+            ChessBoard::tryMove(state, move.from, move.to);
+            ChessBoard::undoMove(state, move.from, move.to, captured);
+        }
+        Bench::doNotOptimize(state);
+    });
+
+    runner.run("chess/aiBoardEval", [&] {
+        int score = ChessBoard::aiBoardEval(state.c_str());
+        Bench::doNotOptimize(score);
+    });
+
+    runner.run("chess/stateString", [&] {
+        std::string s = chess.stateString();
+        Bench::doNotOptimize(s);
+    });
+
+    runner.run("chess/FENtoBoard", [&] {
+        chess.FENtoBoard(kStartFEN);
+    });
+
+    // what a drag asks every frame, the knight on b1 held over each square in turn
+    ChessSquare *knightSquare = chess.getGrid()->getSquare(1, 0);
+    runner.run("chess/canBitMoveFromTo", [&] {
+        int legal = 0;
+        chess.getGrid()->forEachSquare([&](ChessSquare *square, int x, int y) {
+            legal += chess.canBitMoveFromTo(*knightSquare->bit(), *knightSquare, *square);
+        });
+        Bench::doNotOptimize(legal);
+    });
+
+    // what one press of Analyze costs at this depth, the table is cleared every time
+    Search<ChessSearchTraits> search(1 << 16);
+    ChessPosition position = ChessPosition::fromState(state, 1);
+    SearchLimits limits;
+    limits.maxDepth = 3;
+    limits.deterministic = true;
+    limits.multiPV = 3;
+    runner.run("chess/search3Lines", [&] {
+        Bench::doNotOptimize(search.run(position, limits).bestMove);
+    });
+
+    chess.stopGame();
+}
+
+//
+// MultiPV has to agree with the plain search: its first line is the move a one line search plays at the same
+// depth, and no root move is reported twice. prints what went wrong and returns false otherwise
+//
+static bool checkChessLines()
+{
+    Chess chess;
+    chess.setUpBoard();
+    chess.FENtoBoard(kMiddlegameFEN);
+    ChessPosition position = ChessPosition::fromState(chess.stateString(), 1);
+    chess.stopGame();
+
+    bool ok = true;
+    for (int depth = 1; depth <= 4; depth++)
+    {
+        SearchLimits limits;
+        limits.maxDepth = depth;
+        limits.deterministic = true;
+        Search<ChessSearchTraits> single(1 << 16);
+        SearchResult<BitMove> best = single.run(position, limits);
+
+        limits.multiPV = 4;
+        Search<ChessSearchTraits> multi(1 << 16);
+        SearchResult<BitMove> lines = multi.run(position, limits);
+
+        if (lines.lines.size() != 4)
+        {
+            std::cout << "chess lines: depth " << depth << " gave " << lines.lines.size() << " lines, not 4" << std::endl;
+            ok = false;
+            continue;
+        }
+        if (lines.lines[0].move.from != best.bestMove.from || lines.lines[0].move.to != best.bestMove.to)
+        {
+            std::cout << "chess lines: depth " << depth << " best line isn't the one line search's move" << std::endl;
+            ok = false;
+        }
+        for (size_t i = 0; i < lines.lines.size(); i++)
+        {
+            for (size_t j = 0; j < i; j++)
+            {
+                if (ChessSearchTraits::moveIndex(lines.lines[i].move) == ChessSearchTraits::moveIndex(lines.lines[j].move))
+                {
+                    std::cout << "chess lines: depth " << depth << " lists a root move twice" << std::endl;
+                    ok = false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+static void benchOthello(Bench::Runner &runner)
+{
+    Othello othello;
+    othello.setUpBoard();
+
+    // a busy middlegame position with moves for both sides
+    const std::string position =
+        "00000000"
+        "00121000"
+        "01122200"
+        "02211100"
+        "00212120"
+        "00121200"
+        "00012000"
+        "00000000";
+    othello.setStateString(position);
+
+    runner.run("othello/stateString", [&] {
+        std::string s = othello.stateString();
+        Bench::doNotOptimize(s);
+    });
+
+    runner.run("othello/setStateString", [&] {
+        othello.setStateString(position);
+    });
+
+    Player *player = othello.getPlayerAt(0);
+    runner.run("othello/getValidMoves", [&] {
+        auto moves = othello.getValidMoves(player);
+        Bench::doNotOptimize(moves);
+    });
+
+    othello.stopGame();
+}
+
+static void benchCheckers(Bench::Runner &runner)
+{
+    CheckersPosition position;
+    position.board = CheckersBoard::initial();
+    position.side = CheckersRed;
+
+    runner.run("checkers/generateMoves", [&] {
+        CheckersMove moves[CheckersBoard::kMaxMoves];
+        int count = position.board.generateMoves(position.side, moves);
+        Bench::doNotOptimize(count);
+    });
+
+    // red to move with a double jump available
+    CheckersPosition capture;
+    capture.board.red = (1u << 9) | (1u << 1);
+    capture.board.yellow = (1u << 13) | (1u << 21) | (1u << 30);
+    capture.board.kings = 0;
+    capture.side = CheckersRed;
+    runner.run("checkers/generateJumps", [&] {
+        CheckersMove moves[CheckersBoard::kMaxMoves];
+        int count = capture.board.generateMoves(capture.side, moves);
+        Bench::doNotOptimize(count);
+    });
+
+    // the same 64 cursor positions scaled to each board, so the two should cost the same
+    auto squareAtSweep = [&runner](const char *name, int side, float squareSize) {
+        Grid board(side, side);
+        board.initializeSquares(squareSize, "square.png");
+        float extent = side * squareSize;
+        runner.run(name, [&] {
+            for (int i = 0; i < 64; i++)
+            {
+                ImVec2 point(extent * (i % 8 + 0.5f) / 8, extent * (i / 8 + 0.5f) / 8);
+                ChessSquare *square = board.squareAt(point);
+                Bench::doNotOptimize(square);
+            }
+        });
+    };
+    squareAtSweep("grid/squareAt8x8", 8, 80.0f);
+    squareAtSweep("grid/squareAt19x19", 19, 640.0f / 19);
+}
+
+static void benchGomoku(Bench::Runner &runner)
+{
+    // a 15x15 middlegame with stones from both sides around the centre
+    MNKBoard board(15, 15, 5);
+    static const int kStones[][2] = { {7, 7}, {8, 8}, {8, 6}, {6, 8}, {9, 7}, {7, 9}, {6, 6}, {9, 9}, {7, 6}, {8, 7} };
+    for (const auto &stone : kStones)
+    {
+        board.play(stone[1] * 15 + stone[0]);
+    }
+
+    runner.run("gomoku/generateMoves", [&] {
+        int moves[MNKBoard::kMaxCells];
+        int count = board.generateMoves(moves);
+        Bench::doNotOptimize(count);
+    });
+
+    int moves[MNKBoard::kMaxCells];
+    int count = board.generateMoves(moves);
+    runner.run("gomoku/play+remove", [&] {
+        for (int i = 0; i < count; i++)
+        {
+            board.play(moves[i]);
+            board.remove(moves[i]);
+        }
+        Bench::doNotOptimize(board);
+    });
+
+    runner.run("gomoku/findForcedWin", [&] {
+        int move;
+        bool won = board.findForcedWin(16, 20000, move);
+        Bench::doNotOptimize(won);
+    });
+}
+
+static void benchGrid(Bench::Runner &runner)
+{
+    Grid grid(8, 8);
+
+    runner.run("grid/getSquare", [&] {
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 8; x++)
+            {
+                ChessSquare *square = grid.getSquare(x, y);
+                Bench::doNotOptimize(square);
+            }
+        }
+    });
+
+    runner.run("grid/diagonals", [&] {
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 8; x++)
+            {
+                ChessSquare *fl = grid.getFLFL(x, y);
+                ChessSquare *br = grid.getBRBR(x, y);
+                Bench::doNotOptimize(fl);
+                Bench::doNotOptimize(br);
+            }
+        }
+    });
+
+    runner.run("grid/forEachEnabledSquare", [&] {
+        int count = 0;
+        grid.forEachEnabledSquare([&](ChessSquare *square, int x, int y) {
+            count += x + y;
+        });
+        Bench::doNotOptimize(count);
+    });
+}
+
+//
+// whole frames through a headless imgui context, drawFrame plus imgui's own begin/end/render
+//
+static void benchRender(Bench::Runner &runner)
+{
+    ImGui::CreateContext();
+    ImGuiIO &io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1600, 1200);
+    io.DeltaTime = 1.0f / 60.0f;
+    io.Fonts->Build();
+
+    auto frame = [](Game &game) {
+        ImGui::NewFrame();
+        ImGui::Begin("GameWindow");
+        game.drawFrame();
+        ImGui::End();
+        ImGui::Render();
+    };
+
+    Chess chess;
+    chess.setUpBoard();
+    runner.run("render/chessFrame", [&] { frame(chess); });
+    chess.stopGame();
+
+    TicTacToe gomoku(19, 19, 5);
+    gomoku.setUpBoard();
+    runner.run("render/gomoku19Frame", [&] { frame(gomoku); });
+    gomoku.stopGame();
+
+    ImGui::DestroyContext();
+}
+
+int main(int argc, char **argv)
+{
+    std::string outPath = "bench_results.jsonl";
+    std::string baselinePath;
+    std::string filter;
+    double minBatchMs = 2.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--out") && hasValue)
+            outPath = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && hasValue)
+            baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--filter") && hasValue)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "--min-batch-ms") && hasValue)
+            minBatchMs = atof(argv[++i]);
+        else
+        {
+            std::cout << "usage: bench [--out file] [--baseline file] [--filter name] [--min-batch-ms ms]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!checkChessLines())
+    {
+        return 1;
+    }
+
+    Bench::Runner runner(minBatchMs);
+    runner.setFilter(filter);
+
+    benchChess(runner);
+    benchOthello(runner);
+    benchCheckers(runner);
+    benchGomoku(runner);
+    benchGrid(runner);
+    benchRender(runner);
+
+    if (!runner.writeResults(outPath))
+    {
+        return 1;
+    }
+    if (!baselinePath.empty() && !runner.compareWith(baselinePath))
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "Animation.h"
+#include "Bit.h"
+#include <chrono>
+#include <vector>
+
+namespace Animation
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Slide
+    {
+        Bit              *bit;
+        ImVec2            from;
+        ImVec2            to;
+        // where the last update put the bit, anything else means someone moved it since
+        ImVec2            placed;
+        Clock::time_point startTime;
+    };
+
+    static std::vector<Slide> slides;
+
+    static bool samePosition(const ImVec2 &a, const ImVec2 &b)
+    {
+        return a.x == b.x && a.y == b.y;
+    }
+
+    static float easeOut(float t)
+    {
+        float remaining = 1.0f - t;
+        return 1.0f - remaining * remaining * remaining;
+    }
+
+    static void finish(size_t index)
+    {
+        slides[index].bit->setMoving(false);
+        slides[index] = slides.back();
+        slides.pop_back();
+    }
+
+    void start(Bit *bit, const ImVec2 &to)
+    {
+        stop(bit);
+        const ImVec2 &from = bit->getPosition();
+        if (samePosition(from, to))
+        {
+            return;
+        }
+        slides.push_back({ bit, from, to, from, Clock::now() });
+        bit->setMoving(true);
+    }
+
+    void stop(Bit *bit)
+    {
+        for (size_t i = 0; i < slides.size(); i++)
+        {
+            if (slides[i].bit == bit)
+            {
+                finish(i);
+                return;
+            }
+        }
+    }
+
+    void update()
+    {
+        if (slides.empty())
+        {
+            return;
+        }
+        Clock::time_point now = Clock::now();
+        for (size_t i = 0; i < slides.size();)
+        {
+            Slide &slide = slides[i];
+            if (!samePosition(slide.bit->getPosition(), slide.placed))
+            {
+                finish(i);
+                continue;
+            }
+            double elapsed = std::chrono::duration<double>(now - slide.startTime).count();
+            if (elapsed >= kMoveSeconds)
+            {
+                slide.bit->setPosition(slide.to);
+                finish(i);
+                continue;
+            }
+            float t = easeOut((float)(elapsed / kMoveSeconds));
+            slide.placed = ImVec2(slide.from.x + (slide.to.x - slide.from.x) * t, slide.from.y + (slide.to.y - slide.from.y) * t);
+            slide.bit->setPosition(slide.placed);
+            i++;
+        }
+    }
+
+    bool active()
+    {
+        return !slides.empty();
+    }
+
+    int count()
+    {
+        return (int)slides.size();
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../imgui/imgui.h"
+
+class Bit;
+
+//
+// slides bits to where they're going by the clock rather than by the frame
+// only the bits that are moving are kept here, so a frame with nothing moving costs nothing, and active() going
+// false is how the main loop knows it can stop redrawing. each move eases out over kMoveSeconds however fast
+// the frames come. moving a bit somewhere else with setPosition while it slides cancels the slide.
+//
+namespace Animation
+{
+    constexpr double kMoveSeconds = 0.25;
+
+    void start(Bit *bit, const ImVec2 &to);
+    void stop(Bit *bit);
+    // puts every moving bit where it should be by now, the ones that arrive are dropped
+    void update();
+
+    bool active();
+    int  count();
+}
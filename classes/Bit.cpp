@@ -1,10 +1,14 @@
 
 #include "Bit.h"
 #include "BitHolder.h"
-#include <cmath>
+#include "Animation.h"
 
 Bit::~Bit()
 {
+	if (_moving)
+	{
+		Animation::stop(this);
+	}
 }
 
 BitHolder *Bit::getHolder()
@@ -78,29 +82,5 @@ Player *Bit::getOwner()
 
 void Bit::moveTo(const ImVec2 &point)
 {
-	_destinationPosition = point;
-	// work out the step so we move same step each update
-	ImVec2 delta = ImVec2(_destinationPosition.x - getPosition().x, _destinationPosition.y - getPosition().y);
-	_destinationStep = ImVec2(delta.x * 0.05f, delta.y * 0.05f);
-	_moving = true;
+	Animation::start(this, point);
 }
-
-void Bit::update()
-{
-	if (!_moving)
-	{
-		return;
-	}
-	ImVec2 pos = getPosition();
-	ImVec2 delta = ImVec2(_destinationPosition.x - pos.x, _destinationPosition.y - pos.y);
-	if (std::fabs(delta.x) >= 0.1f || std::fabs(delta.y) > 0.1f)
-	{
-		ImVec2 newPosition = ImVec2(pos.x + _destinationStep.x, pos.y + _destinationStep.y);
-		setPosition(newPosition);
-	}
-	else
-	{
-		setPosition(_destinationPosition);
-		_moving = false;
-	}
-}
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 class Player;
 class BitHolder;
+class BitPool;
 
 //
 // these aren't used yet but will be used for dragging pieces
@@ -29,6 +30,7 @@ public:
 		_gameTag = 0;
 		_entityType = EntityBit;
 		_moving = false;
+		_pool = nullptr;
 	};
 
 	~Bit();
@@ -48,11 +50,12 @@ public:
 	// game defined game tags
 	const int gameTag() const { return _gameTag; };
 	void setGameTag(int tag) { _gameTag = tag; };
-	// move to a position
+	// slide to a position, see Animation
 	void moveTo(const ImVec2 &point);
-	void update();
 	void setOpacity(float opacity){};
-	bool getMoving() { return _moving; };
+	bool getMoving() const { return _moving; };
+	// kept up to date by Animation
+	void setMoving(bool moving) { _moving = moving; };
 
 private:
 	int _restingZ;
@@ -60,7 +63,9 @@ private:
 	bool _pickedUp;
 	Player *_owner;
 	int _gameTag;
-	ImVec2 _destinationPosition;
-	ImVec2 _destinationStep;
 	bool _moving;
+	// where the bit goes back to when its holder destroys it, nullptr for bits that came from new
+	BitPool *_pool;
+
+	friend class BitPool;
 };
@@ -1,5 +1,6 @@
 #include "BitHolder.h"
 #include "Bit.h"
+#include "BitPool.h"
 
 BitHolder::~BitHolder()
 {
@@ -28,7 +29,7 @@ void BitHolder::setBit(Bit *abit)
 	{
 		if (_bit)
 		{
-			delete _bit;
+			BitPool::destroy(_bit);
 			_bit = nullptr;
 		}
 		_bit = abit;
@@ -43,7 +44,7 @@ void BitHolder::destroyBit()
 {
 	if (_bit)
 	{
-		delete _bit;
+		BitPool::destroy(_bit);
 		_bit = nullptr;
 	}
 }
@@ -0,0 +1,41 @@
+#include "BitPool.h"
+#include "Animation.h"
+
+Bit *BitPool::acquire()
+{
+    if (_free.empty())
+    {
+        _chunks.push_back(std::make_unique<Bit[]>(kChunkSize));
+        Bit *chunk = _chunks.back().get();
+        // handed out from the front of the chunk first
+        for (int i = kChunkSize - 1; i >= 0; i--)
+        {
+            _free.push_back(&chunk[i]);
+        }
+    }
+    Bit *bit = _free.back();
+    _free.pop_back();
+    *bit = Bit();
+    bit->_pool = this;
+    return bit;
+}
+
+void BitPool::release(Bit *bit)
+{
+    if (bit->getMoving())
+    {
+        Animation::stop(bit);
+    }
+    // an empty parent keeps a holder that still points here from treating it as its piece
+    bit->setParent(nullptr);
+    bit->_pool = nullptr;
+    _free.push_back(bit);
+}
+
+void BitPool::destroy(Bit *bit)
+{
+    if (bit->_pool)
+        bit->_pool->release(bit);
+    else
+        delete bit;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Bit.h"
+#include <memory>
+#include <vector>
+
+//
+// a game's pieces, allocated in chunks and recycled
+// acquire() hands out a Bit in its freshly constructed state, and a holder destroying a pooled bit puts it back on
+// the free list instead of deleting it, so setting up a board or loading a position reuses the same few chunks.
+// the pool owns the memory of every bit it ever handed out, it has to outlive the holders that point at them.
+//
+class BitPool
+{
+public:
+    static constexpr int kChunkSize = 64;
+
+    BitPool() = default;
+    BitPool(const BitPool &) = delete;
+    BitPool &operator=(const BitPool &) = delete;
+
+    Bit *acquire();
+    void release(Bit *bit);
+
+    // returns a bit to whichever pool it came from, or deletes it if it came from new
+    static void destroy(Bit *bit);
+
+    // bits allocated so far, and how many of them are waiting to be reused
+    int capacity() const { return (int)_chunks.size() * kChunkSize; }
+    int available() const { return (int)_free.size(); }
+
+private:
+    std::vector<std::unique_ptr<Bit[]>> _chunks;
+    std::vector<Bit *>                  _free;
+};
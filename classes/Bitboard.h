@@ -3,6 +3,27 @@
 #include <intrin.h>
 #endif
 #include <iostream>
+#include <cstdint>
+
+// index of the lowest set bit, bb must not be zero
+inline int bitScanForward64(uint64_t bb) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, bb);
+    return (int)index;
+#else
+    return __builtin_ctzll(bb);
+#endif
+}
+
+inline int popCount64(uint64_t bb) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (int)__popcnt64(bb);
+#else
+    return __builtin_popcountll(bb);
+#endif
+}
+
 enum ChessPiece
 {
     NoPiece,
@@ -1,11 +1,20 @@
 #include "Checkers.h"
+#include "Bitboard.h"
+#include "CheckersEndgameDB.h"
 
-Checkers::Checkers() : Game() {
+Checkers::Checkers() : Game(), _search(1 << 18) {
     _grid = new Grid(8, 8);
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    _redPieces = 12;
-    _yellowPieces = 12;
+    _jumpingSquare = -1;
+
+    // the endgame database is optional, build it with tools/checkers_egdb. mapped once and kept for the whole run
+    static CheckersEndgameDB endgameDB;
+    static bool triedOpening = false;
+    if (!triedOpening) {
+        triedOpening = true;
+        if (endgameDB.open("resources/checkers_endgame.db")) {
+            CheckersSearchTraits::endgameDB = &endgameDB;
+        }
+    }
 }
 
 Checkers::~Checkers() {
@@ -20,29 +29,29 @@ void Checkers::setUpBoard() {
     // Initialize all squares
     _grid->initializeSquares(80, "boardsquare.png");
 
-    // Enable only dark squares and place pieces
+    // Only the dark squares are played on
     _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        bool isDark = (x + y) % 2 == 1;
-        _grid->setEnabled(x, y, isDark);
-
-        if (isDark) {
-            if (y < 3) {
-                Bit* piece = createPiece(RED_PIECE);
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            } else if (y > 4) {
-                Bit* piece = createPiece(YELLOW_PIECE);
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            }
-        }
+        _grid->setEnabled(x, y, CheckersBoard::squareAt(x, y) >= 0);
     });
 
+    _board = CheckersBoard::initial();
+    _jumpingSquare = -1;
+    for (int square = 0; square < 32; square++) {
+        int pieceType = pieceTypeAt(square);
+        if (pieceType != EMPTY) {
+            placePiece(square, pieceType);
+        }
+    }
+
+    if (gameHasAI()) {
+        setAIPlayer(AI_PLAYER);
+    }
+
     startGame();
 }
 
 Bit* Checkers::createPiece(int pieceType) {
-    Bit* bit = new Bit();
+    Bit* bit = _bitPool.acquire();
     bool isRed = (pieceType == RED_PIECE || pieceType == RED_KING);
     bit->LoadTextureFromFile(isRed ? "red.png" : "yellow.png");
     bit->setOwner(getPlayerAt(isRed ? RED_PLAYER : YELLOW_PLAYER));
@@ -52,194 +61,119 @@ Bit* Checkers::createPiece(int pieceType) {
     return bit;
 }
 
+// puts a sprite on the square, the bitboards are updated by the caller
+void Checkers::placePiece(int square, int pieceType) {
+    ChessSquare* holder = holderAt(square);
+    Bit* piece = createPiece(pieceType);
+    piece->setPosition(holder->getPosition());
+    holder->setBit(piece);
+}
+
+int Checkers::squareOf(BitHolder &holder) const {
+    ChessSquare* square = static_cast<ChessSquare*>(&holder);
+    return CheckersBoard::squareAt(square->getColumn(), square->getRow());
+}
+
+ChessSquare* Checkers::holderAt(int square) const {
+    int x, y;
+    CheckersBoard::coordinates(square, x, y);
+    return _grid->getSquare(x, y);
+}
+
+int Checkers::pieceTypeAt(int square) const {
+    uint32_t bit = 1u << square;
+    bool king = (_board.kings & bit) != 0;
+    if (_board.red & bit) return king ? RED_KING : RED_PIECE;
+    if (_board.yellow & bit) return king ? YELLOW_KING : YELLOW_PIECE;
+    return EMPTY;
+}
+
+// brings the sprite in line when the board crowned the piece on square
+void Checkers::crownIfPromoted(int square) {
+    Bit* bit = holderAt(square)->bit();
+    int pieceType = pieceTypeAt(square);
+    if (bit && bit->gameTag() != pieceType) {
+        bit->setGameTag(pieceType);
+        bit->setScale(1.3f);
+    }
+}
+
 bool Checkers::actionForEmptyHolder(BitHolder &holder) {
     return false; // Checkers doesn't place new pieces
 }
 
 bool Checkers::canBitMoveFrom(Bit &bit, BitHolder &src) {
     if (!src.bit() || bit.getOwner() != getCurrentPlayer()) return false;
-    if (_mustContinueJumping && &src != _jumpingPiece) return false;
 
-    ChessSquare* square = static_cast<ChessSquare*>(&src);
-    int x = square->getColumn();
-    int y = square->getRow();
+    int square = squareOf(src);
+    if (square < 0) return false;
+    if (_jumpingSquare >= 0) return square == _jumpingSquare;
 
     // Must jump if available
-    if (hasJumpAvailable(bit.getOwner())) {
-        return canJumpFrom(*square);
+    if (_board.canCapture(getCurrentPlayer()->playerNumber())) {
+        return _board.jumpTargets(square) != 0;
     }
-    return true;
+    return _board.stepTargets(square) != 0;
 }
 
 bool Checkers::canBitMoveFromTo(Bit& bit, BitHolder& src, BitHolder& dst) {
     if (!src.bit() || dst.bit()) return false;
 
-    ChessSquare* srcSquare = static_cast<ChessSquare*>(&src);
-    ChessSquare* dstSquare = static_cast<ChessSquare*>(&dst);
-
-    int srcX = srcSquare->getColumn();
-    int srcY = srcSquare->getRow();
-
-    if (!_grid->isEnabled(dstSquare->getColumn(), dstSquare->getRow())) return false;
-
-    bool isKing = (bit.gameTag() == RED_KING || bit.gameTag() == YELLOW_KING);
-    bool isRed = (bit.getOwner() == getPlayerAt(RED_PLAYER));
-
-    // Simple moves (if no jumps required)
-    if (!_mustContinueJumping && !hasJumpAvailable(bit.getOwner())) {
-        if (isKing) {
-            return dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY) ||
-                   dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY);
-        }
-        return isRed ? (dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY)) :
-                       (dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY));
-    }
-
-    // Jump moves
-    if (_mustContinueJumping && &src != _jumpingPiece) return false;
-
-    // Check all jump directions
-    auto checkJump = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        if (!middle || !target || !middle->bit()) return false;
-        if (middle->bit()->getOwner() == bit.getOwner()) return false;
-        return dstSquare == target;
-    };
-
-    if (isKing || !isRed) {
-        if (checkJump(_grid->getFL(srcX, srcY), _grid->getFLFL(srcX, srcY))) return true;
-        if (checkJump(_grid->getFR(srcX, srcY), _grid->getFRFR(srcX, srcY))) return true;
-    }
-    if (isKing || isRed) {
-        if (checkJump(_grid->getBL(srcX, srcY), _grid->getBLBL(srcX, srcY))) return true;
-        if (checkJump(_grid->getBR(srcX, srcY), _grid->getBRBR(srcX, srcY))) return true;
-    }
+    int from = squareOf(src);
+    int to = squareOf(dst);
+    if (from < 0 || to < 0) return false;
+    if (_jumpingSquare >= 0 && from != _jumpingSquare) return false;
 
-    return false;
+    uint32_t targets = (_jumpingSquare >= 0 || _board.canCapture(getCurrentPlayer()->playerNumber()))
+                           ? _board.jumpTargets(from)
+                           : _board.stepTargets(from);
+    return (targets >> to) & 1;
 }
 
 void Checkers::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
-    ChessSquare* srcSquare = static_cast<ChessSquare*>(&src);
-    ChessSquare* dstSquare = static_cast<ChessSquare*>(&dst);
-
-    int srcX = srcSquare->getColumn();
-    int srcY = srcSquare->getRow();
-    int dstX = dstSquare->getColumn();
-    int dstY = dstSquare->getRow();
-
-    // Check for jump
-    ChessSquare* jumped = nullptr;
-    if (dstSquare == _grid->getFLFL(srcX, srcY)) jumped = _grid->getFL(srcX, srcY);
-    else if (dstSquare == _grid->getFRFR(srcX, srcY)) jumped = _grid->getFR(srcX, srcY);
-    else if (dstSquare == _grid->getBLBL(srcX, srcY)) jumped = _grid->getBL(srcX, srcY);
-    else if (dstSquare == _grid->getBRBR(srcX, srcY)) jumped = _grid->getBR(srcX, srcY);
-
-    if (jumped && jumped->bit()) {
-        // Capture
-        (jumped->bit()->getOwner() == getPlayerAt(RED_PLAYER)) ? _redPieces-- : _yellowPieces--;
-        jumped->destroyBit();
-
-        // Promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
-
-        // Check for more jumps
-        if (canJumpFrom(*dstSquare)) {
-            _mustContinueJumping = true;
-            _jumpingPiece = &dst;
-            return;
-        }
-    } else {
-        // Regular move - promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
+    int side = getCurrentPlayer()->playerNumber();
+    CheckersMove move;
+    move.from = (uint8_t)squareOf(src);
+    move.to = (uint8_t)squareOf(dst);
+
+    // a jump lands two steps away, the piece in between is taken
+    uint32_t fromBit = 1u << move.from;
+    uint32_t toBit = 1u << move.to;
+    for (int direction = CheckersBoard::UpLeft; direction <= CheckersBoard::DownRight; direction++) {
+        uint32_t over = CheckersBoard::step(fromBit, direction);
+        if (CheckersBoard::step(over, direction) == toBit && (over & _board.pieces(1 - side))) {
+            move.captured = over;
         }
     }
 
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    endTurn();
-}
-
-bool Checkers::canJumpFrom(ChessSquare& square) const {
-    Bit* piece = square.bit();
-    if (!piece) return false;
-
-    int x = square.getColumn();
-    int y = square.getRow();
-    bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-    bool isRed = (piece->getOwner() == getPlayerAt(RED_PLAYER));
-    Player* player = piece->getOwner();
-
-    auto checkJumpDir = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        return middle && middle->bit() && middle->bit()->getOwner() != player &&
-               target && !target->bit();
-    };
-
-    if (isKing || !isRed) {
-        if (checkJumpDir(_grid->getFL(x, y), _grid->getFLFL(x, y))) return true;
-        if (checkJumpDir(_grid->getFR(x, y), _grid->getFRFR(x, y))) return true;
+    bool wasKing = (_board.kings & fromBit) != 0;
+    _board.play(side, move);
+    if (move.captured) {
+        holderAt(bitScanForward64(move.captured))->destroyBit();
     }
-    if (isKing || isRed) {
-        if (checkJumpDir(_grid->getBL(x, y), _grid->getBLBL(x, y))) return true;
-        if (checkJumpDir(_grid->getBR(x, y), _grid->getBRBR(x, y))) return true;
+    crownIfPromoted(move.to);
+
+    // Keep jumping with the same piece, crowning ends the move
+    bool crowned = !wasKing && (_board.kings & toBit);
+    if (move.captured && !crowned && _board.jumpTargets(move.to)) {
+        // the turn isn't over but the board has changed
+        _jumpingSquare = move.to;
+        boardChanged();
+        return;
     }
-    return false;
-}
 
-bool Checkers::hasJumpAvailable(Player* player) const {
-    bool hasJump = false;
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (hasJump) return;
-        Bit* piece = square->bit();
-        if (piece && piece->getOwner() == player) {
-            Checkers* self = const_cast<Checkers*>(this);
-            if (self->canJumpFrom(*square)) {
-                hasJump = true;
-            }
-        }
-    });
-    return hasJump;
+    _jumpingSquare = -1;
+    endTurn();
 }
 
 Player* Checkers::checkForWinner() {
-    if (_redPieces == 0) return getPlayerAt(YELLOW_PLAYER);
-    if (_yellowPieces == 0) return getPlayerAt(RED_PLAYER);
+    if (!_board.red) return getPlayerAt(YELLOW_PLAYER);
+    if (!_board.yellow) return getPlayerAt(RED_PLAYER);
 
-    // Check if current player has any moves
+    // A player who cannot move loses
     Player* current = getCurrentPlayer();
-    bool hasMove = false;
-
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (hasMove) return;
-        Bit* piece = square->bit();
-        if (piece && piece->getOwner() == current) {
-            bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-            bool isRed = (current == getPlayerAt(RED_PLAYER));
-
-            // Check for any valid move
-            auto checkMove = [&](ChessSquare* target) {
-                if (target && !target->bit()) hasMove = true;
-            };
-
-            if (isKing) {
-                checkMove(_grid->getFL(x, y));
-                checkMove(_grid->getFR(x, y));
-                checkMove(_grid->getBL(x, y));
-                checkMove(_grid->getBR(x, y));
-            } else if (isRed) {
-                checkMove(_grid->getBL(x, y));
-                checkMove(_grid->getBR(x, y));
-            } else {
-                checkMove(_grid->getFL(x, y));
-                checkMove(_grid->getFR(x, y));
-            }
-        }
-    });
-
-    if (!hasMove) {
+    CheckersMove moves[CheckersBoard::kMaxMoves];
+    if (_board.generateMoves(current->playerNumber(), moves) == 0) {
         return current == getPlayerAt(RED_PLAYER) ? getPlayerAt(YELLOW_PLAYER) : getPlayerAt(RED_PLAYER);
     }
     return nullptr;
@@ -253,42 +187,75 @@ void Checkers::stopGame() {
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    _redPieces = 12;
-    _yellowPieces = 12;
+    _board = CheckersBoard();
+    _jumpingSquare = -1;
 }
 
 std::string Checkers::initialStateString() {
-    return "111111111111--------333333333333";
+    return "11111111111100000000333333333333";
 }
 
 std::string Checkers::stateString() {
-    return _grid->getStateString();
+    std::string state(32, '0');
+    for (int square = 0; square < 32; square++) {
+        state[square] = (char)('0' + pieceTypeAt(square));
+    }
+    return state;
 }
 
 void Checkers::setStateString(const std::string &s) {
     if (s.length() != 32) return;
 
-    _redPieces = 0;
-    _yellowPieces = 0;
-
-    _grid->setStateString(s);
-
-    // Recreate pieces from state
-    size_t index = 0;
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (index < s.length()) {
-            int pieceType = s[index++] - '0';
-            if (pieceType != 0) {
-                Bit* piece = createPiece(pieceType);
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-                (pieceType == RED_PIECE || pieceType == RED_KING) ? _redPieces++ : _yellowPieces++;
-            }
-        }
-    });
+    boardChanged();
+    _board = CheckersBoard();
+    _jumpingSquare = -1;
+    for (int square = 0; square < 32; square++) {
+        holderAt(square)->destroyBit();
+
+        int pieceType = s[square] - '0';
+        uint32_t bit = 1u << square;
+        if (pieceType == RED_PIECE || pieceType == RED_KING) _board.red |= bit;
+        else if (pieceType == YELLOW_PIECE || pieceType == YELLOW_KING) _board.yellow |= bit;
+        else continue;
+        if (pieceType == RED_KING || pieceType == YELLOW_KING) _board.kings |= bit;
+        placePiece(square, pieceType);
+    }
 }
 
-void Checkers::updateAI() {}
+void Checkers::updateAI() {
+    if (!gameHasAI()) return;
 
+    CheckersPosition position;
+    position.board = _board;
+    position.side = (uint8_t)getCurrentPlayer()->playerNumber();
+
+    // inside the endgame database only the moves that keep its result are searched
+    std::vector<CheckersMove> rootMoves;
+    if (CheckersSearchTraits::endgameDB) {
+        rootMoves = CheckersSearchTraits::endgameDB->bestMoves(_board, position.side);
+    }
+
+    SearchLimits limits;
+    limits.timeMs = 1000;
+    auto result = _search.run(position, limits, rootMoves.empty() ? nullptr : &rootMoves);
+    if (!result.hasMove) return;
+    CheckersMove move = result.bestMove;
+
+    // the whole sequence at once: move the sprite, take the captured pieces, crown
+    ChessSquare* fromSquare = holderAt(move.from);
+    ChessSquare* toSquare = holderAt(move.to);
+    Bit* piece = fromSquare->bit();
+    // hand the piece over before clearing the old square, clearing a square that still holds it destroys it
+    toSquare->setBit(piece);
+    fromSquare->setBit(nullptr);
+    piece->moveTo(toSquare->getPosition());
+
+    _board.play(position.side, move);
+    for (uint32_t captured = move.captured; captured; captured &= captured - 1) {
+        holderAt(bitScanForward64(captured))->destroyBit();
+    }
+    crownIfPromoted(move.to);
+
+    _jumpingSquare = -1;
+    endTurn();
+}
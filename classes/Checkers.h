@@ -1,5 +1,6 @@
 #pragma once
 #include "Game.h"
+#include "CheckersBoard.h"
 
 // NOTE: If Square class needs modifications to support colored squares for checkerboard pattern,
 // add a method like setColor(ImVec4 color) to Square class
@@ -25,7 +26,7 @@ public:
 
     // AI methods
     void        updateAI() override;
-    bool        gameHasAI() override { return false; } // Set to true when AI is implemented
+    bool        gameHasAI() override { return true; }
     Grid* getGrid() override { return _grid; }
 
 private:
@@ -42,23 +43,18 @@ private:
 
     // Helper methods
     Bit*        createPiece(int pieceType);
-    int         getPieceType(const Bit& bit) const;
-    bool        isKing(const Bit& bit) const;
-    bool        isValidMove(int srcX, int srcY, int dstX, int dstY, Player* player) const;
-    bool        isJumpMove(int srcX, int srcY, int dstX, int dstY) const;
-    bool        hasJumpAvailable(Player* player) const;
-    bool        canJumpFrom(ChessSquare& square) const;
-    void        performJump(int srcX, int srcY, int dstX, int dstY);
-    void        promoteToKing(Bit& bit, int y);
-    void        getBoardPosition(BitHolder &holder, int &x, int &y) const;
-    bool        isValidSquare(int x, int y) const;
+    void        placePiece(int square, int pieceType);
+    int         squareOf(BitHolder &holder) const;
+    ChessSquare* holderAt(int square) const;
+    void        crownIfPromoted(int square);
+    int         pieceTypeAt(int square) const;
 
-    // Board representation
+    // Board representation, the bitboards are the rules and the grid only shows them
     Grid*        _grid;
+    CheckersBoard _board;
 
-    // Game state
-    bool        _mustContinueJumping;
-    BitHolder*  _jumpingPiece;
-    int         _redPieces;
-    int         _yellowPieces;
+    // Game state, the square of a piece part way through a multi-jump or -1
+    int         _jumpingSquare;
+
+    Search<CheckersSearchTraits> _search;
 };
\ No newline at end of file
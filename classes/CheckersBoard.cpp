@@ -0,0 +1,365 @@
+#include "CheckersBoard.h"
+#include "Bitboard.h"
+#include "CheckersEndgameDB.h"
+#include <cstdlib>
+
+// rows with y even hold their dark squares on x = 1, 3, 5, 7 and rows with y odd on x = 0, 2, 4, 6
+static const uint32_t kEvenRows = 0x0F0F0F0Fu;
+static const uint32_t kOddRows = 0xF0F0F0F0u;
+// first and last dark square of each row, x = 0 on odd rows and x = 7 on even rows have no neighbor on that side
+static const uint32_t kFirstInRow = 0x11111111u;
+static const uint32_t kLastInRow = 0x88888888u;
+
+// men only move forward, kings go every way
+static inline bool movesToward(int side, bool king, int direction)
+{
+    if (king)
+    {
+        return true;
+    }
+    return side == CheckersRed ? direction >= CheckersBoard::DownLeft : direction <= CheckersBoard::UpRight;
+}
+
+// UpLeft <-> DownRight, UpRight <-> DownLeft
+static inline int opposite(int direction)
+{
+    return 3 - direction;
+}
+
+CheckersBoard CheckersBoard::initial()
+{
+    CheckersBoard board;
+    board.red = 0x00000FFFu;
+    board.yellow = 0xFFF00000u;
+    board.kings = 0;
+    return board;
+}
+
+int CheckersBoard::squareAt(int x, int y)
+{
+    if (x < 0 || x > 7 || y < 0 || y > 7 || (x + y) % 2 == 0)
+    {
+        return -1;
+    }
+    return y * 4 + x / 2;
+}
+
+void CheckersBoard::coordinates(int square, int &x, int &y)
+{
+    y = square / 4;
+    x = (square % 4) * 2 + ((y % 2 == 0) ? 1 : 0);
+}
+
+// squares off the board fall out of the 32 bits or are masked away before the shift
+uint32_t CheckersBoard::step(uint32_t bits, int direction)
+{
+    switch (direction)
+    {
+    case UpLeft:
+        return ((bits & kEvenRows) >> 4) | ((bits & kOddRows & ~kFirstInRow) >> 5);
+    case UpRight:
+        return ((bits & kEvenRows & ~kLastInRow) >> 3) | ((bits & kOddRows) >> 4);
+    case DownLeft:
+        return ((bits & kEvenRows) << 4) | ((bits & kOddRows & ~kFirstInRow) << 3);
+    case DownRight:
+        return ((bits & kEvenRows & ~kLastInRow) << 5) | ((bits & kOddRows) << 4);
+    }
+    return 0;
+}
+
+uint32_t CheckersBoard::jumpTargets(int square) const
+{
+    uint32_t bit = 1u << square;
+    if (!((red | yellow) & bit))
+    {
+        return 0;
+    }
+    int side = (red & bit) ? CheckersRed : CheckersYellow;
+    bool king = (kings & bit) != 0;
+    uint32_t opponent = pieces(1 - side);
+    uint32_t open = empty();
+
+    uint32_t targets = 0;
+    for (int direction = UpLeft; direction <= DownRight; direction++)
+    {
+        if (movesToward(side, king, direction))
+        {
+            targets |= step(step(bit, direction) & opponent, direction) & open;
+        }
+    }
+    return targets;
+}
+
+uint32_t CheckersBoard::stepTargets(int square) const
+{
+    uint32_t bit = 1u << square;
+    if (!((red | yellow) & bit))
+    {
+        return 0;
+    }
+    int side = (red & bit) ? CheckersRed : CheckersYellow;
+    bool king = (kings & bit) != 0;
+    uint32_t open = empty();
+
+    uint32_t targets = 0;
+    for (int direction = UpLeft; direction <= DownRight; direction++)
+    {
+        if (movesToward(side, king, direction))
+        {
+            targets |= step(bit, direction) & open;
+        }
+    }
+    return targets;
+}
+
+bool CheckersBoard::canCapture(int side) const
+{
+    uint32_t own = pieces(side);
+    uint32_t opponent = pieces(1 - side);
+    uint32_t open = empty();
+    for (int direction = UpLeft; direction <= DownRight; direction++)
+    {
+        uint32_t movers = movesToward(side, false, direction) ? own : (own & kings);
+        if (step(step(movers, direction) & opponent, direction) & open)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int CheckersBoard::generateMoves(int side, CheckersMove *moves) const
+{
+    int count = 0;
+    uint32_t own = pieces(side);
+    uint32_t open = empty();
+
+    if (canCapture(side))
+    {
+        uint32_t opponent = pieces(1 - side);
+        for (uint32_t bits = own; bits; bits &= bits - 1)
+        {
+            int from = bitScanForward64(bits);
+            addJumps(side, (kings >> from) & 1, 1u << from, from, opponent, open, 0, moves, count);
+        }
+        return count;
+    }
+
+    // plain steps, one direction at a time for every piece that can take it
+    for (int direction = UpLeft; direction <= DownRight; direction++)
+    {
+        uint32_t movers = movesToward(side, false, direction) ? own : (own & kings);
+        for (uint32_t targets = step(movers, direction) & open; targets && count < kMaxMoves; targets &= targets - 1)
+        {
+            uint32_t to = targets & (0u - targets);
+            CheckersMove &move = moves[count++];
+            move.from = (uint8_t)bitScanForward64(step(to, opposite(direction)));
+            move.to = (uint8_t)bitScanForward64(to);
+            move.captured = 0;
+        }
+    }
+    return count;
+}
+
+static void recordJump(int from, uint32_t at, uint32_t captured, CheckersMove *moves, int &count)
+{
+    if (count >= CheckersBoard::kMaxMoves)
+    {
+        return;
+    }
+    CheckersMove move;
+    move.from = (uint8_t)from;
+    move.to = (uint8_t)bitScanForward64(at);
+    move.captured = captured;
+    // a king circling back can reach the same result by two routes
+    for (int i = 0; i < count; i++)
+    {
+        if (moves[i] == move)
+        {
+            return;
+        }
+    }
+    moves[count++] = move;
+}
+
+//
+// follows a capture sequence from the square at, open holds the squares the piece may land on.
+// the sequence is recorded when no further jump exists, or when a man is crowned, which ends the move.
+//
+void CheckersBoard::addJumps(int side, bool king, uint32_t at, int from, uint32_t opponent, uint32_t open,
+                             uint32_t captured, CheckersMove *moves, int &count) const
+{
+    bool extended = false;
+    for (int direction = UpLeft; direction <= DownRight; direction++)
+    {
+        if (!movesToward(side, king, direction))
+        {
+            continue;
+        }
+        uint32_t over = step(at, direction) & opponent;
+        uint32_t land = step(over, direction) & open;
+        if (!land)
+        {
+            continue;
+        }
+        extended = true;
+        if (!king && (land & crownRow(side)))
+        {
+            recordJump(from, land, captured | over, moves, count);
+            continue;
+        }
+        addJumps(side, king, land, from, opponent & ~over, (open & ~land) | at | over, captured | over, moves, count);
+    }
+
+    if (!extended && captured)
+    {
+        recordJump(from, at, captured, moves, count);
+    }
+}
+
+void CheckersBoard::play(int side, const CheckersMove &move)
+{
+    uint32_t fromBit = 1u << move.from;
+    uint32_t toBit = 1u << move.to;
+    uint32_t &own = side == CheckersRed ? red : yellow;
+    uint32_t &opponent = side == CheckersRed ? yellow : red;
+
+    bool king = (kings & fromBit) != 0;
+    own = (own & ~fromBit) | toBit;
+    opponent &= ~move.captured;
+    kings &= ~(fromBit | move.captured);
+    if (king || (toBit & crownRow(side)))
+    {
+        kings |= toBit;
+    }
+}
+
+// ==============================================================
+// search traits
+// ==============================================================
+
+static const int kManValue = 100;
+static const int kKingValue = 160;
+// men left on the back row keep the opponent from crowning
+static const int kBackRowGuard = 8;
+// per row a man has advanced
+static const int kAdvance = 2;
+// how much fewer pieces on the board make the side ahead hunt down the rest
+static const int kEndgamePieces = 8;
+static const int kClosingIn = 4;
+// a database win, below the search's forced wins since the distance to the win is not known
+static const int kDatabaseWin = 100000;
+
+// the sum over the attacker's pieces of how many king steps away the nearest defending piece is
+static int closingDistance(const CheckersBoard &board, int attacker)
+{
+    int distance = 0;
+    for (uint32_t attackers = board.pieces(attacker); attackers; attackers &= attackers - 1)
+    {
+        int ax, ay;
+        CheckersBoard::coordinates(bitScanForward64(attackers), ax, ay);
+        int nearest = 8;
+        for (uint32_t targets = board.pieces(1 - attacker); targets; targets &= targets - 1)
+        {
+            int tx, ty;
+            CheckersBoard::coordinates(bitScanForward64(targets), tx, ty);
+            nearest = std::min(nearest, std::max(std::abs(ax - tx), std::abs(ay - ty)));
+        }
+        distance += nearest;
+    }
+    return distance;
+}
+
+void CheckersSearchTraits::makeMove(Position &pos, const Move &move, Undo &undo)
+{
+    undo = pos.board;
+    pos.board.play(pos.side, move);
+    pos.side ^= 1;
+}
+
+void CheckersSearchTraits::unmakeMove(Position &pos, const Move &move, const Undo &undo)
+{
+    pos.board = undo;
+    pos.side ^= 1;
+}
+
+int CheckersSearchTraits::evaluate(const Position &pos)
+{
+    const CheckersBoard &board = pos.board;
+    uint32_t redMen = board.red & ~board.kings;
+    uint32_t yellowMen = board.yellow & ~board.kings;
+
+    // from red's point of view
+    int score = kManValue * (popCount64(redMen) - popCount64(yellowMen)) +
+                kKingValue * (popCount64(board.red & board.kings) - popCount64(board.yellow & board.kings));
+    score += kBackRowGuard * (popCount64(redMen & CheckersBoard::crownRow(CheckersYellow)) -
+                              popCount64(yellowMen & CheckersBoard::crownRow(CheckersRed)));
+    for (int y = 0; y < 8; y++)
+    {
+        uint32_t row = 0xFu << (4 * y);
+        score += kAdvance * (y * popCount64(redMen & row) - (7 - y) * popCount64(yellowMen & row));
+    }
+    // with few pieces left, the side ahead closes in instead of waiting
+    if (popCount64(board.red | board.yellow) <= kEndgamePieces && score != 0)
+    {
+        int ahead = score > 0 ? CheckersRed : CheckersYellow;
+        int closing = kClosingIn * closingDistance(board, ahead);
+        score += ahead == CheckersRed ? -closing : closing;
+    }
+    return pos.side == CheckersRed ? score : -score;
+}
+
+bool CheckersSearchTraits::isTerminal(const Position &pos, int &score)
+{
+    if (pos.board.pieces(pos.side))
+    {
+        return false;
+    }
+    score = -SearchScore::kWin;
+    return true;
+}
+
+uint64_t CheckersSearchTraits::hash(const Position &pos)
+{
+    uint64_t pieces = ((uint64_t)pos.board.red << 32) | pos.board.yellow;
+    return zobristKey(pieces ^ zobristKey(((uint64_t)pos.board.kings << 1) | pos.side));
+}
+
+int CheckersSearchTraits::orderScore(const Position &pos, const Move &move)
+{
+    int score = 100 * popCount64(move.captured);
+    bool man = !((pos.board.kings >> move.from) & 1);
+    if (man && ((1u << move.to) & CheckersBoard::crownRow(pos.side)))
+    {
+        score += 50;
+    }
+    return score;
+}
+
+//
+// the database only knows win, loss or draw, so decided positions still score material and how closely
+// the winner is hemming the loser in. that way the search prefers the wins that make progress.
+//
+bool CheckersSearchTraits::probe(const Position &pos, int &score)
+{
+    if (!endgameDB)
+    {
+        return false;
+    }
+    CheckersEndgameDB::Value value = endgameDB->probe(pos.board, pos.side);
+    if (value == CheckersEndgameDB::Unknown)
+    {
+        return false;
+    }
+    if (value == CheckersEndgameDB::Draw)
+    {
+        score = 0;
+        return true;
+    }
+
+    int winner = value == CheckersEndgameDB::Win ? pos.side : 1 - pos.side;
+    int distance = closingDistance(pos.board, winner);
+    int progress = evaluate(pos) - kClosingIn * distance * (winner == pos.side ? 1 : -1);
+    score = value == CheckersEndgameDB::Win ? kDatabaseWin + progress : -kDatabaseWin + progress;
+    return true;
+}
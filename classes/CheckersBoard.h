@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Search.h"
+#include <cstdint>
+
+//
+// bitboard checkers core
+// only the 32 dark squares are used, numbered in the same order as the state string: row by row from y = 0,
+// four to a row. red starts on 0-11 and moves towards higher rows, yellow starts on 20-31 and moves the other way.
+// a diagonal neighbor is 3, 4 or 5 squares away depending on the row, so every step is a mask and a shift
+// and all of the pieces that can make the same kind of step are found at once.
+//
+enum CheckersSide
+{
+    CheckersRed = 0,
+    CheckersYellow = 1
+};
+
+struct CheckersMove
+{
+    uint8_t from = 0;
+    uint8_t to = 0;
+    // opponent pieces taken on the way, 0 for a plain step
+    uint32_t captured = 0;
+
+    bool operator==(const CheckersMove &other) const
+    {
+        return from == other.from && to == other.to && captured == other.captured;
+    }
+};
+
+struct CheckersBoard
+{
+    enum Direction
+    {
+        UpLeft,
+        UpRight,
+        DownLeft,
+        DownRight
+    };
+
+    static constexpr int kMaxMoves = 128;
+
+    uint32_t red = 0;
+    uint32_t yellow = 0;
+    // kings of either color
+    uint32_t kings = 0;
+
+    static CheckersBoard initial();
+
+    // -1 for the light squares
+    static int      squareAt(int x, int y);
+    static void     coordinates(int square, int &x, int &y);
+    static uint32_t step(uint32_t bits, int direction);
+    // the row where the side's men are crowned
+    static uint32_t crownRow(int side) { return side == CheckersRed ? 0xF0000000u : 0x0000000Fu; }
+
+    uint32_t pieces(int side) const { return side == CheckersRed ? red : yellow; }
+    uint32_t empty() const { return ~(red | yellow); }
+
+    // landing squares of the single jumps and of the plain steps open to the piece on square
+    uint32_t jumpTargets(int square) const;
+    uint32_t stepTargets(int square) const;
+    bool     canCapture(int side) const;
+
+    // every legal move for the side, captures are mandatory and multi-jumps are followed to the end.
+    // returns the count, at most kMaxMoves
+    int      generateMoves(int side, CheckersMove *moves) const;
+
+    // captured pieces come off straight away, men reaching the far row are crowned
+    void     play(int side, const CheckersMove &move);
+
+private:
+    void     addJumps(int side, bool king, uint32_t at, int from, uint32_t opponent, uint32_t open,
+                      uint32_t captured, CheckersMove *moves, int &count) const;
+};
+
+//
+// search plumbing: the board and whose turn it is
+//
+struct CheckersPosition
+{
+    CheckersBoard board;
+    uint8_t side;
+};
+
+class CheckersEndgameDB;
+
+struct CheckersSearchTraits
+{
+    using Position = CheckersPosition;
+    using Move = CheckersMove;
+    // boards are twelve bytes, cheaper to copy than to work backwards
+    using Undo = CheckersBoard;
+
+    static constexpr int kMaxMoves = CheckersBoard::kMaxMoves;
+    static constexpr int kMoveIndexSize = 32 * 32;
+
+    static int      generateMoves(const Position &pos, Move *moves) { return pos.board.generateMoves(pos.side, moves); }
+    static void     makeMove(Position &pos, const Move &move, Undo &undo);
+    static void     unmakeMove(Position &pos, const Move &move, const Undo &undo);
+    static int      evaluate(const Position &pos);
+    static bool     isTerminal(const Position &pos, int &score);
+    static int      noMovesScore(const Position &pos) { return -SearchScore::kWin; }
+    static uint64_t hash(const Position &pos);
+    static int      orderScore(const Position &pos, const Move &move);
+    static int      moveIndex(const Move &move) { return move.from * 32 + move.to; }
+    static bool     probe(const Position &pos, int &score);
+
+    // probed during search when set, see Checkers::Checkers
+    static inline const CheckersEndgameDB *endgameDB = nullptr;
+};
@@ -0,0 +1,264 @@
+#include "CheckersEndgameDB.h"
+#include "Bitboard.h"
+#include <cstring>
+
+// men never stand on their own crown row, so each color's men have 28 squares to choose from
+static const int kMenSquares = 28;
+
+struct Binomials
+{
+    uint64_t c[33][CheckersEndgameDB::kMaxPieces + 2];
+
+    constexpr Binomials() : c()
+    {
+        for (int n = 0; n <= 32; n++)
+        {
+            c[n][0] = 1;
+            for (int k = 1; k <= CheckersEndgameDB::kMaxPieces + 1; k++)
+            {
+                c[n][k] = n == 0 ? 0 : c[n - 1][k - 1] + c[n - 1][k];
+            }
+        }
+    }
+};
+static constexpr Binomials kBinomials;
+
+static inline uint64_t binomial(int n, int k)
+{
+    return (n < 0 || k < 0) ? 0 : kBinomials.c[n][k];
+}
+
+// square s becomes 31 - s
+static inline uint32_t reverseBits(uint32_t v)
+{
+    v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+    v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+    v = ((v >> 4) & 0x0F0F0F0Fu) | ((v & 0x0F0F0F0Fu) << 4);
+    v = ((v >> 8) & 0x00FF00FFu) | ((v & 0x00FF00FFu) << 8);
+    return (v >> 16) | (v << 16);
+}
+
+//
+// combinations of squares, ranked in colex order. squares below offset and the ones in removed are skipped,
+// so the kings are numbered over just the squares the men left free.
+//
+static uint64_t rankSquares(uint32_t squares, uint32_t removed, int offset)
+{
+    uint64_t rank = 0;
+    int i = 0;
+    for (; squares; squares &= squares - 1)
+    {
+        int square = bitScanForward64(squares);
+        int position = square - offset - popCount64(removed & ((1u << square) - 1));
+        rank += binomial(position, ++i);
+    }
+    return rank;
+}
+
+static uint32_t unrankSquares(uint64_t rank, int count, int domain, uint32_t removed, int offset)
+{
+    uint32_t squares = 0;
+    int position = domain;
+    for (int i = count; i > 0; i--)
+    {
+        do
+        {
+            position--;
+        } while (binomial(position, i) > rank);
+        rank -= binomial(position, i);
+
+        // the position-th square of the domain
+        int seen = -1;
+        for (int square = offset; square < 32; square++)
+        {
+            if (!(removed & (1u << square)) && ++seen == position)
+            {
+                squares |= 1u << square;
+                break;
+            }
+        }
+    }
+    return squares;
+}
+
+CheckersBoard CheckersEndgameDB::canonical(const CheckersBoard &board, int side)
+{
+    if (side == CheckersRed)
+    {
+        return board;
+    }
+    CheckersBoard turned;
+    turned.red = reverseBits(board.yellow);
+    turned.yellow = reverseBits(board.red);
+    turned.kings = reverseBits(board.kings);
+    return turned;
+}
+
+CheckersEndgameDB::SliceKey CheckersEndgameDB::sliceKeyOf(const CheckersBoard &board)
+{
+    SliceKey key;
+    key.redMen = popCount64(board.red & ~board.kings);
+    key.redKings = popCount64(board.red & board.kings);
+    key.yellowMen = popCount64(board.yellow & ~board.kings);
+    key.yellowKings = popCount64(board.yellow & board.kings);
+    return key;
+}
+
+uint64_t CheckersEndgameDB::sliceSize(const SliceKey &key)
+{
+    int men = key.redMen + key.yellowMen;
+    return binomial(kMenSquares, key.redMen) * binomial(kMenSquares, key.yellowMen) *
+           binomial(32 - men, key.redKings) * binomial(32 - men - key.redKings, key.yellowKings);
+}
+
+uint64_t CheckersEndgameDB::indexOf(const CheckersBoard &board)
+{
+    SliceKey key = sliceKeyOf(board);
+    uint32_t redMen = board.red & ~board.kings;
+    uint32_t yellowMen = board.yellow & ~board.kings;
+    uint32_t redKings = board.red & board.kings;
+    uint32_t yellowKings = board.yellow & board.kings;
+    uint32_t men = redMen | yellowMen;
+    int menCount = key.redMen + key.yellowMen;
+
+    uint64_t index = rankSquares(redMen, 0, 0);
+    index = index * binomial(kMenSquares, key.yellowMen) + rankSquares(yellowMen, 0, 4);
+    index = index * binomial(32 - menCount, key.redKings) + rankSquares(redKings, men, 0);
+    index = index * binomial(32 - menCount - key.redKings, key.yellowKings) + rankSquares(yellowKings, men | redKings, 0);
+    return index;
+}
+
+bool CheckersEndgameDB::boardAt(const SliceKey &key, uint64_t index, CheckersBoard &board)
+{
+    int menCount = key.redMen + key.yellowMen;
+    uint64_t yellowKingsSize = binomial(32 - menCount - key.redKings, key.yellowKings);
+    uint64_t redKingsSize = binomial(32 - menCount, key.redKings);
+    uint64_t yellowMenSize = binomial(kMenSquares, key.yellowMen);
+
+    uint64_t yellowKingsRank = index % yellowKingsSize;
+    index /= yellowKingsSize;
+    uint64_t redKingsRank = index % redKingsSize;
+    index /= redKingsSize;
+    uint64_t yellowMenRank = index % yellowMenSize;
+    uint64_t redMenRank = index / yellowMenSize;
+
+    uint32_t redMen = unrankSquares(redMenRank, key.redMen, kMenSquares, 0, 0);
+    uint32_t yellowMen = unrankSquares(yellowMenRank, key.yellowMen, kMenSquares, 0, 4);
+    if (redMen & yellowMen)
+    {
+        return false;
+    }
+    uint32_t men = redMen | yellowMen;
+    uint32_t redKings = unrankSquares(redKingsRank, key.redKings, 32 - menCount, men, 0);
+    uint32_t yellowKings = unrankSquares(yellowKingsRank, key.yellowKings, 32 - menCount - key.redKings, men | redKings, 0);
+
+    board.red = redMen | redKings;
+    board.yellow = yellowMen | yellowKings;
+    board.kings = redKings | yellowKings;
+    return true;
+}
+
+CheckersEndgameDB::~CheckersEndgameDB()
+{
+    close();
+}
+
+bool CheckersEndgameDB::open(const char *path)
+{
+    close();
+
+    if (!_file.open(path))
+    {
+        return false;
+    }
+    _data = _file.data();
+    _size = _file.size();
+
+    // check the header and that every slice lies inside the file before trusting any of it
+    FileHeader header;
+    bool valid = _size >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, _data, sizeof(header));
+        valid = memcmp(header.magic, "CKDB", 4) == 0 && header.version == kVersion &&
+                header.maxPieces <= (uint32_t)kMaxPieces &&
+                _size >= sizeof(header) + (uint64_t)header.sliceCount * sizeof(FileSlice);
+    }
+    if (valid)
+    {
+        _slices.assign((kMaxPieces + 1) * (kMaxPieces + 1) * (kMaxPieces + 1) * (kMaxPieces + 1), nullptr);
+        for (uint32_t i = 0; i < header.sliceCount && valid; i++)
+        {
+            FileSlice slice;
+            memcpy(&slice, _data + sizeof(header) + i * sizeof(FileSlice), sizeof(slice));
+            SliceKey key = { slice.redMen, slice.redKings, slice.yellowMen, slice.yellowKings };
+            valid = key.redMen + key.redKings + key.yellowMen + key.yellowKings <= (int)header.maxPieces &&
+                    slice.positions == sliceSize(key) &&
+                    slice.offset <= _size && (slice.positions + 3) / 4 <= _size - slice.offset;
+            if (valid)
+            {
+                _slices[slot(key)] = _data + slice.offset;
+            }
+        }
+    }
+    if (!valid)
+    {
+        close();
+        return false;
+    }
+    _maxPieces = (int)header.maxPieces;
+    return true;
+}
+
+void CheckersEndgameDB::close()
+{
+    _file.close();
+    _data = nullptr;
+    _size = 0;
+    _maxPieces = 0;
+    _slices.clear();
+}
+
+CheckersEndgameDB::Value CheckersEndgameDB::probe(const CheckersBoard &board, int side) const
+{
+    if (!_data || popCount64(board.red | board.yellow) > _maxPieces)
+    {
+        return Unknown;
+    }
+    CheckersBoard position = canonical(board, side);
+    if (!position.red)
+    {
+        return Loss;
+    }
+    if (!position.yellow)
+    {
+        return Win;
+    }
+    const uint8_t *values = _slices[slot(sliceKeyOf(position))];
+    return values ? readValue(values, indexOf(position)) : Unknown;
+}
+
+std::vector<CheckersMove> CheckersEndgameDB::bestMoves(const CheckersBoard &board, int side) const
+{
+    std::vector<CheckersMove> best;
+    Value value = probe(board, side);
+    if (value == Unknown)
+    {
+        return best;
+    }
+    // a win needs a move into a lost position for the opponent, a draw one into a drawn position
+    Value wanted = value == Win ? Loss : (value == Draw ? Draw : Win);
+
+    CheckersMove moves[CheckersBoard::kMaxMoves];
+    int count = board.generateMoves(side, moves);
+    for (int i = 0; i < count; i++)
+    {
+        CheckersBoard child = board;
+        child.play(side, moves[i]);
+        if (probe(child, 1 - side) == wanted)
+        {
+            best.push_back(moves[i]);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CheckersBoard.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// checkers endgame database
+// win/loss/draw for every position with up to maxPieces() pieces, built offline by tools/checkers_egdb
+// and memory mapped here so the search can probe it without loading anything up front.
+//
+// positions are stored with red to move, a yellow to move position is turned around first (the board rotated
+// half a turn, which reverses the square numbers, and the colors swapped). they are grouped into slices by
+// piece counts and each slice is a flat array of 2 bit values, indexed by ranking the men and then the kings
+// as combinations of squares.
+//
+class CheckersEndgameDB
+{
+public:
+    enum Value : uint8_t
+    {
+        Unknown = 0,
+        Win = 1,
+        Loss = 2,
+        Draw = 3
+    };
+
+    // the most pieces the index can handle, the generator defaults to 6
+    static constexpr int kMaxPieces = 10;
+
+    CheckersEndgameDB() = default;
+    ~CheckersEndgameDB();
+    CheckersEndgameDB(const CheckersEndgameDB &) = delete;
+    CheckersEndgameDB &operator=(const CheckersEndgameDB &) = delete;
+
+    bool open(const char *path);
+    void close();
+    bool isOpen() const { return _data != nullptr; }
+    int  maxPieces() const { return _maxPieces; }
+
+    // the value for the side to move, Unknown when the position has too many pieces
+    Value probe(const CheckersBoard &board, int side) const;
+    // the moves that keep the best result the table promises, empty when the position is not in the table
+    std::vector<CheckersMove> bestMoves(const CheckersBoard &board, int side) const;
+
+    //
+    // indexing, shared with the generator
+    //
+    struct SliceKey
+    {
+        int redMen;
+        int redKings;
+        int yellowMen;
+        int yellowKings;
+    };
+
+    // the same position with red to move
+    static CheckersBoard canonical(const CheckersBoard &board, int side);
+    static SliceKey      sliceKeyOf(const CheckersBoard &board);
+    static uint64_t      sliceSize(const SliceKey &key);
+    static uint64_t      indexOf(const CheckersBoard &board);
+    // false for the index values that put two men on one square, those are never looked up
+    static bool          boardAt(const SliceKey &key, uint64_t index, CheckersBoard &board);
+
+    // value of a canonical position inside a slice's packed array
+    static Value readValue(const uint8_t *values, uint64_t index)
+    {
+        return (Value)((values[index >> 2] >> ((index & 3) * 2)) & 3);
+    }
+
+    //
+    // file layout: the header, one FileSlice per slice, then the packed values
+    //
+    struct FileHeader
+    {
+        char     magic[4];
+        uint32_t version;
+        uint32_t maxPieces;
+        uint32_t sliceCount;
+    };
+
+    struct FileSlice
+    {
+        uint8_t  redMen;
+        uint8_t  redKings;
+        uint8_t  yellowMen;
+        uint8_t  yellowKings;
+        uint32_t reserved;
+        // from the start of the file
+        uint64_t offset;
+        uint64_t positions;
+    };
+
+    static constexpr uint32_t kVersion = 1;
+
+private:
+    static int slot(const SliceKey &key)
+    {
+        return ((key.redMen * (kMaxPieces + 1) + key.redKings) * (kMaxPieces + 1) + key.yellowMen) * (kMaxPieces + 1) + key.yellowKings;
+    }
+
+    MappedFile      _file;
+    const uint8_t  *_data = nullptr;
+    size_t          _size = 0;
+    int             _maxPieces = 0;
+    // packed values of each slice by slot(), null for slices not in the file
+    std::vector<const uint8_t *> _slices;
+};
@@ -4,37 +4,38 @@
 #include <string>
 #include <ctype.h>
 #include <cctype>
-#include "Bitboard.h"
+#include <cstring>
 
 using namespace std;
 
-// ==============================================================
-// global variables
-// ==============================================================
-
-int rowOffset = 0;
-int colOffset = 0;
-int bishopOffsets[4][2] = { {1,1}, {1,-1}, {-1,1}, {-1,-1} };
-int rookOffsets[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
-static int pieceValue[128] = {0};
-
-void initPieceValues() {
-    pieceValue['P'] = 100; pieceValue['N'] = 320; pieceValue['B'] = 320; pieceValue['R'] = 500; pieceValue['Q'] = 900; pieceValue['K'] = 20000;
-    pieceValue['p'] = -100; pieceValue['n'] = -320; pieceValue['b'] = -320; pieceValue['r'] = -500; pieceValue['q'] = -900; pieceValue['k'] = -20000;
-};
-
 // ==============================================================
 // constructors, destructors
 // ==============================================================
 
-Chess::Chess()
+Chess::Chess() : _search(1 << 18)
 {
-    initPieceValues();
     _grid = new Grid(8, 8);
+    // runs on the search thread, a full ring just means the window misses a depth
+    _search.onIteration([this](const SearchResult<BitMove> &result) {
+        ChessSearchProgress progress;
+        progress.depth = result.depth;
+        progress.score = result.score;
+        progress.nodes = result.nodes;
+        progress.timeMs = result.timeMs;
+        progress.lineCount = min((int)result.lines.size(), ChessSearchProgress::kMaxLines);
+        for(int i = 0; i < progress.lineCount; i++) {
+            const SearchLine<BitMove> &line = result.lines[i];
+            progress.lines[i].score = line.score;
+            progress.lines[i].pvLength = min((int)line.pv.size(), ChessSearchProgress::kMaxPV);
+            copy_n(line.pv.begin(), progress.lines[i].pvLength, progress.lines[i].pv);
+        }
+        _progressRing.push(progress);
+    });
 }
 
 Chess::~Chess()
 {
+    stopThinking();
     delete _grid;
 }
 
@@ -62,7 +63,7 @@ char Chess::pieceNotation(int x, int y) const {
 Bit* Chess::PieceForPlayer(const int playerNumber, ChessPiece piece) {
     const char* pieces[] =  { "pawn.png", "knight.png", "bishop.png", "rook.png", "queen.png", "king.png" };
 
-    Bit* bit = new Bit();
+    Bit* bit = _bitPool.acquire();
 
     const char* pieceName = pieces[piece -1];
     string spritePath = string("") + (playerNumber == 0 ? "w_" : "b_") + pieceName;
@@ -94,6 +95,7 @@ void Chess::FENtoBoard(const string& fen) {
     // the fen string or reading it in reverse.
     int col = 0;
     int row = 7; 
+    boardChanged();
     for (char piece : fen) {
         switch (piece) {
             case 'r': case 'R':
@@ -174,9 +176,15 @@ bool Chess::checkForDraw()
 
 void Chess::stopGame()
 {
+    stopThinking();
+    if (!_tableFile.empty()) {
+        _search.table().save(_tableFile.c_str());
+    }
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
+    boardChanged();
+    clearBoardHighlights();
 }
 
 string Chess::initialStateString() { return stateString(); }
@@ -190,14 +198,21 @@ string Chess::stateString() {
     );
     return s;}
 
+// the inverse of stateString, one piece letter or '0' per square
 void Chess::setStateString(const string &s) {
+    if (s.length() != 64) return;
+
+    // undo, redo and the turn slider come through here, a search of the old position is no use now
+    stopThinking();
+    boardChanged();
+    clearBoardHighlights();
+    const char *pieces = "PNBRQK";
     _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y * 8 + x;
-        char playerNumber = s[index] - '0';
-        if (playerNumber) {
-            square->setBit(PieceForPlayer(playerNumber - 1, Pawn));
-        } else {
-            square->setBit(nullptr);
+        square->destroyBit();
+        char notation = s[y * 8 + x];
+        const char *piece = notation != '0' ? strchr(pieces, toupper(static_cast<unsigned char>(notation))) : nullptr;
+        if (piece) {
+            pieceSetFEN(x, y, notation, (ChessPiece)(piece - pieces + Pawn));
         }
     });
 }
@@ -213,279 +228,135 @@ bool Chess::actionForEmptyHolder(BitHolder &holder) {
 bool Chess::canBitMoveFrom(Bit &bit, BitHolder &src) {
     int currentPlayer = getCurrentPlayer()->playerNumber() * 128;
     int pieceColor = bit.gameTag() & 128;
-    if(pieceColor == currentPlayer) return true;
-    return false;
+    if(pieceColor != currentPlayer) return false;
+
+    // picking the piece up shows where it can go, until the drag or click ends
+    ChessSquare* fromSquare = dynamic_cast<ChessSquare*>(&src);
+    if(fromSquare) {
+        clearBoardHighlights();
+        _hintedSquares = legalTargets(pieceColor ? 'B' : 'W')[fromSquare->getSquareIndex()];
+        for(uint64_t bits = _hintedSquares; bits; bits &= bits - 1) {
+            int index = bitScanForward64(bits);
+            _grid->getSquare(index % 8, index / 8)->setMoveHint(true);
+        }
+    }
+    return true;
 }
 
+// called every frame of a drag, so it only looks the move up
 bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &from, BitHolder &to) {
     ChessSquare* fromSquare = dynamic_cast<ChessSquare*>(&from);
     ChessSquare* toSquare = dynamic_cast<ChessSquare*>(&to);
 
     if(!fromSquare || !toSquare) return false;
  
-    string state = stateString();
     char color = (bit.gameTag() <  128) ? 'W' : 'B';
-    auto moves = generateMoves(state.c_str(), color);
-
-    int fromIndex = fromSquare->getRow() * 8 + fromSquare->getColumn();
-    int toIndex = toSquare->getRow() * 8 + toSquare->getColumn();
-
-    for(auto &move : moves){
-        if(move.from == fromIndex && move.to == toIndex) return true;
-    }
-    return false;
-}
-
-PieceColor Chess::stateColor(int col, int row) {
-    ChessSquare* square = _grid->getSquare(col, row);
-    if (!square || !square->bit()) return EMPTY;
-    return (square->bit()->gameTag() < 128) ? WHITE : BLACK;
+    return (legalTargets(color)[fromSquare->getSquareIndex()] >> toSquare->getSquareIndex()) & 1;
 }
 
-// all move generation functionality basically operates the same, checking for a valid initial position before passing piece-specific offsets into
-// the calculate moves function template that utilizes callable parameter to apply the offsets
-void Chess::generatePawnMoves(const char *state, vector<BitMove>& moves, int row, int col, int colorInt) {
-    rowOffset = (colorInt == 1) ? 1 : -1; colOffset = 0;
-    int startRow = (colorInt == 1) ? 1 : 6; 
-    // forward moves
-    if(row > 0 && row < 7){
-            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset) * 8 + (col + colOffset)]; });
-        if(row == startRow){
-            rowOffset = rowOffset * 2;
-            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset) * 8 + (col + colOffset)]; });
-        }
-    }
-    // captures
-    if (col > 0) {
-        rowOffset = (colorInt == 1 ) ? 1 : -1; colOffset = -1;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset) * 8 + (col + colOffset)]; });
-    }
-    if (col < 7) {
-        rowOffset = (colorInt == 1 ) ? 1 : -1; colOffset = 1;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset) * 8 + (col + colOffset)]; });
+const uint64_t* Chess::legalTargets(char color) {
+    if(_legalTargetsColor != color || _legalTargetsVersion != boardVersion()) {
+        string state = stateString();
+        memset(_legalTargets, 0, sizeof(_legalTargets));
+        for(auto &move : ChessBoard::generateMoves(state.c_str(), color)) {
+            _legalTargets[move.from] |= 1ull << move.to;
         }
+        _legalTargetsColor = color;
+        _legalTargetsVersion = boardVersion();
     }
-
-void Chess::generateKnightMoves(const char *state, vector<BitMove>& moves, int row, int col, int colorInt) {
-    if (row > 0 && col < 6){
-        rowOffset = -1; colOffset = 2;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row < 7 && col < 6){
-        rowOffset = 1; colOffset = 2;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row < 7 && col > 1){
-        rowOffset = 1; colOffset = -2;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row > 0 && col > 1){
-        rowOffset = -1; colOffset = -2;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row < 6 && col > 0){
-        rowOffset = 2; colOffset = -1;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row > 1 && col > 0){
-        rowOffset = -2; colOffset = -1;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row < 6 && col < 7){
-        rowOffset = 2; colOffset = 1;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row > 1 && col < 7){
-        rowOffset = -2; colOffset = 1;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
+    return _legalTargets;
 }
 
-void Chess::generateKingMoves(const char *state, vector<BitMove>& moves, int row, int col, int colorInt) {
-    // for my own reference, a row offset of 1 is a single space up towards the board. A col offset of 1 is one move to the right
-    if (row >= 0){
-        rowOffset = 1; colOffset = 0;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row <= 7){
-        rowOffset = -1; colOffset = 0;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (col > 0){
-        rowOffset = 0; colOffset = -1;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (col < 7){
-        rowOffset = 0; colOffset = 1;
-        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    // diagonal moves
-    if (row >= 0 && row < 7 && col < 7){ 
-            rowOffset = 1; colOffset = 1;
-            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row > 0 && row <= 7 && col < 7){ 
-            rowOffset = -1; colOffset = 1;
-            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row >= 0 && row < 7 && col > 0){ 
-            rowOffset = 1; colOffset = -1;
-            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
-    if (row > 0 && row <= 7 && col > 0){ 
-            rowOffset = -1; colOffset = -1;
-            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
-    }
+bool Chess::clickedBit(Bit &bit) {
+    clearBoardHighlights();
+    return true;
 }
 
-void Chess::generateBishopAndRookMoves(const char* state, vector<BitMove>& moves, int row, int col, int colorInt, int offsets[][2], int numOffsets) {
-    for(int i = 0; i < numOffsets; i++) {
-        rowOffset = offsets[i][0];
-        colOffset = offsets[i][1];
-        int depth = 1;
-        while(true) {
-            
-            int rowIncrementValue = rowOffset * depth;
-            int colIncrementValue = colOffset * depth;
-            if(row + rowIncrementValue < 0 || row + rowIncrementValue  > 7 || col + colIncrementValue < 0 || col + colIncrementValue > 7) break;
-            calculateMoves(state, moves, row, rowIncrementValue, col, colIncrementValue, colorInt, [&]{ return state[ (row + rowIncrementValue) * 8 + (col + colIncrementValue)];});
-
-            char target = state[(row + rowIncrementValue) * 8 + (col + colIncrementValue)];
-            if (target != '0') break;
-            depth++;
-        }
+void Chess::clearBoardHighlights() {
+    for(; _hintedSquares; _hintedSquares &= _hintedSquares - 1) {
+        int index = bitScanForward64(_hintedSquares);
+        _grid->getSquare(index % 8, index / 8)->setMoveHint(false);
     }
 }
 
-void Chess::addMove(const char *state, vector<BitMove>& moves, int fromRow, int fromCol, int toRow, int toCol) {
-    if(toRow >= 0 && toRow < 8 && toCol >= 0 && toCol < 8) {
-        int fromColor = stateColor(fromCol, fromRow);
-        int toColor = stateColor(toCol, toRow);
-
-        if(fromColor != toColor) {
-            moves.emplace_back(fromRow * 8 + fromCol, toRow * 8 + toCol, Knight);
-        }
-    }
+// every way a turn can end goes through here, moves made by dragging and by the AI
+void Chess::endTurn() {
+    clearBoardHighlights();
+    Game::endTurn();
 }
 
-vector<BitMove> Chess::generateMoves(const char* state, char color) {
-    vector<BitMove> moves;
-    moves.reserve(40);
-
-    int colorInt = (color == 'W')  ? 1 : -1;
-
-    for(int i = 0; i < 64; i++) {
-        int row = i / 8;
-        int col = i % 8;
-        char piece = state[i];
-        int pieceColor = (piece == '0') ? 0 : (piece < 'a') ? 1 : -1;
-        if(pieceColor == colorInt){
-            if(toupper(static_cast<unsigned char>(piece)) == 'P') generatePawnMoves(state, moves, row, col, colorInt);
-            if(toupper(static_cast<unsigned char>(piece)) == 'N') generateKnightMoves(state, moves, row, col, colorInt);
-            if(toupper(static_cast<unsigned char>(piece)) == 'K') generateKingMoves(state, moves, row, col, colorInt);
-            if(toupper(static_cast<unsigned char>(piece)) == 'R') {
-                generateBishopAndRookMoves(state, moves, row, col, colorInt, rookOffsets, 4);
-            }
-            if(toupper(static_cast<unsigned char>(piece)) == 'B') {
-                generateBishopAndRookMoves(state, moves, row, col, colorInt, bishopOffsets, 4);
-            }
-            if(toupper(static_cast<unsigned char>(piece)) == 'Q') {
-                generateBishopAndRookMoves(state, moves, row, col, colorInt, rookOffsets, 4);
-                generateBishopAndRookMoves(state, moves, row, col, colorInt, bishopOffsets, 4);
-            }
-        }
-    }
-    return moves;
+PieceColor Chess::stateColor(int col, int row) {
+    ChessSquare* square = _grid->getSquare(col, row);
+    if (!square || !square->bit()) return EMPTY;
+    return (square->bit()->gameTag() < 128) ? WHITE : BLACK;
 }
 
-// ==================================================
-// AI Functions
-// ==================================================
-
-void Chess::tryMove(string &state, int from, int to) {
-    state[to] = state[from];
-    state[from] = '0';
+void Chess::analyze(int lineCount, SearchLimits limits) {
+    stopThinking();
+    limits.multiPV = clamp(lineCount, 1, ChessSearchProgress::kMaxLines);
+    // white is player 0 and moves with color 1
+    startSearch(getCurrentPlayer()->playerNumber() == 0 ? 1 : -1, limits, true);
 }
 
-void Chess::undoMove(string &state, int from, int to, char capturedPiece) {
-    state[from] = state[to];
-    state[to] = capturedPiece;
+void Chess::setTableFile(const string &path) {
+    stopThinking();
+    _tableFile = path;
+    _search.table().load(path.c_str());
 }
 
-int Chess::aiBoardEval(const string &state) {
-    // iterate through the state string and add score based on values designated to each piece in pieceValue look up table
-    // created in the constructor
-    int score = 0;
-    for (char piece : state) {
-        score += pieceValue[(int)piece];
+void Chess::stopThinking() {
+    if(_searchThread.joinable()) {
+        _stopSearch = true;
+        _searchThread.join();
     }
-    return score;
-}
-
-
-bool Chess::aiTestForTerminal(const string &state) {
-    bool whiteKing=false, blackKing=false;
-    for (char c : state) {
-        if(c=='K') whiteKing = true;
-        if(c=='k') blackKing=true;
+    _stopSearch = false;
+    _searchDone = false;
+    // nothing is writing now, so what's left in the ring is from the search just stopped
+    ChessSearchProgress stale;
+    while(_progressRing.pop(stale)) {
     }
-    return !whiteKing || !blackKing;
 }
 
-int Chess::negamax(string &state, int depth, int alpha, int beta, int playerColor) {
-    if(depth == 0 || aiTestForTerminal(state)) return aiBoardEval(state) * playerColor;
-
-    int bestVal = -99999;
-
-    char colorChar = (playerColor == 1) ? 'W' : 'B';
-    auto moves = generateMoves(state.c_str(), colorChar);
-
-    if(moves.empty())
-        return aiBoardEval(state) * playerColor;
-
-    // iterate through the moves, try each and recursively call negamax. undo moves and determine best move
-    // if alpha beta threshold met, discard
-    for(auto &move : moves) {
-        char capturedPiece = state[move.to];
-        tryMove(state, move.from, move.to);
-
-        int val = -negamax(state, depth-1, -beta, -alpha, -playerColor);
-
-        undoMove(state, move.from, move.to, capturedPiece);
-
-        bestVal = max(bestVal, val);
-        alpha = max(alpha, val);
+SearchLimits Chess::difficultyLimits() const {
+    const ChessDifficulty &difficulty = chessDifficulties[_difficulty];
+    SearchLimits limits;
+    limits.maxDepth = difficulty.maxDepth;
+    limits.maxNodes = difficulty.maxNodes;
+    limits.timeMs = difficulty.timeMs;
+    limits.deterministic = _reproducible;
+    return limits;
+}
 
-        if(alpha >= beta)
-            break;
-    }
-    return bestVal;
+void Chess::startSearch(int color, SearchLimits limits, bool analysis) {
+    ChessPosition position = ChessPosition::fromState(stateString(), color);
+    limits.stop = &_stopSearch;
+    _searchVersion = boardVersion();
+    _analyzing = analysis;
+    _progress = ChessSearchProgress();
+    _searchThread = thread([this, position, limits]() mutable {
+        _searchResult = _search.run(position, limits);
+        _searchDone.store(true, memory_order_release);
+    });
 }
 
+// called every frame on the AI's turn: starts the search, then plays its move once the thread has one
 void Chess::updateAI() {
+    // an analysis the human asked for is over once it's the AI's turn
+    if(_searchThread.joinable() && (_analyzing || _searchVersion != boardVersion())) {
+        stopThinking();
+    }
 
-    // generate all possible moves to be scored by negamax
-    string baseState = stateString();
-    auto moves = generateMoves(baseState.c_str(), 'B');
-    if(moves.empty()) return;
-
-    int bestScore = -99999;
-    BitMove bestMove = moves[0];
-
-    for(auto &move : moves) {
-        
-        // test moves on the state, perform negamax base call, replace bestMove based on scores
-        string state = baseState;
-
-        tryMove(state, move.from, move.to);
-        // negamax depth 5. Any higher and it takes forever to think/crashes on this implementation.
-        int score = -negamax(state, 5-1, -99999, 99999, 1);
-
-        if(score > bestScore) {
-            bestScore = score;
-            bestMove = move;
-        }
+    if(!_searchThread.joinable()) {
+        // the AI plays black
+        startSearch(-1, difficultyLimits(), false);
+        return;
     }
+    if(!_searchDone.load(memory_order_acquire)) return;
+
+    _searchThread.join();
+    _searchDone = false;
+    if(!_searchResult.hasMove) return;
+    BitMove bestMove = _searchResult.bestMove;
 
     // convert move indices to grid, take the move, end the turn
     ChessSquare* fromSquare = _grid->getSquare(bestMove.from % 8, bestMove.from / 8);
@@ -497,4 +368,49 @@ void Chess::updateAI() {
     activePiece->moveTo(toSquare->getPosition());
     endTurn();
 
+}
+
+static string squareName(int index) {
+    return { (char)('a' + index % 8), (char)('1' + index / 8) };
+}
+
+void Chess::drawAIStatus() {
+    const char *names[chessDifficultyCount];
+    for(int i = 0; i < chessDifficultyCount; i++) {
+        names[i] = chessDifficulties[i].name;
+    }
+    ImGui::Combo("AI Difficulty", &_difficulty, names, chessDifficultyCount);
+    ImGui::Checkbox("Same move every time", &_reproducible);
+    // the human can ask for the best few moves on their own turn, searched with the AI's limits
+    if(!getCurrentPlayer()->isAIPlayer() && !_gameOptions.AIvsAI) {
+        if(ImGui::Button("Analyze")) {
+            analyze(_analysisLines, difficultyLimits());
+        }
+        ImGui::SameLine();
+        ImGui::SliderInt("Lines", &_analysisLines, 1, ChessSearchProgress::kMaxLines);
+    }
+
+    ChessSearchProgress progress;
+    while(_progressRing.pop(progress)) {
+        _progress = progress;
+    }
+    if(_progress.depth == 0) return;
+
+    int64_t nodesPerSecond = (int64_t)(_progress.nodes * 1000 / max<int64_t>(_progress.timeMs, 1));
+    bool finished = _searchDone || !_searchThread.joinable();
+    const char *state = finished ? (_analyzing ? "done" : "played") : "thinking";
+    ImGui::Text("%s %s depth %d  score %d", _analyzing ? "Analysis" : "AI", state, _progress.depth, _progress.score);
+    ImGui::Text("%llu nodes  %lld nps", (unsigned long long)_progress.nodes, (long long)nodesPerSecond);
+    for(int i = 0; i < _progress.lineCount; i++) {
+        const ChessSearchProgress::Line &line = _progress.lines[i];
+        string moves;
+        for(int j = 0; j < line.pvLength; j++) {
+            moves += squareName(line.pv[j].from) + squareName(line.pv[j].to) + " ";
+        }
+        if(_progress.lineCount == 1) {
+            ImGui::TextWrapped("PV: %s", moves.c_str());
+        } else {
+            ImGui::TextWrapped("%d. %d  %s", i + 1, line.score, moves.c_str());
+        }
+    }
 }
\ No newline at end of file
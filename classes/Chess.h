@@ -2,10 +2,48 @@
 
 #include "Game.h"
 #include "Grid.h"
-#include "Bitboard.h"
+#include "ChessBoard.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <thread>
 
 constexpr int pieceSize = 80;
 enum PieceColor { EMPTY, WHITE, BLACK };
+
+// how hard the AI plays. timeMs is the most a move can take, maxNodes is what a reproducible move gets instead
+struct ChessDifficulty {
+    const char *name;
+    int maxDepth;
+    uint64_t maxNodes;
+    int64_t timeMs;
+};
+constexpr ChessDifficulty chessDifficulties[] = {
+    { "Beginner", 2,     5000,  100 },
+    { "Casual",   3,    50000,  250 },
+    { "Club",     5,  1000000, 1000 },
+    { "Expert",   8, 10000000, 5000 },
+};
+constexpr int chessDifficultyCount = sizeof(chessDifficulties) / sizeof(chessDifficulties[0]);
+
+// what the AI's search has found so far, sent from the search thread after each depth.
+// fixed size so it goes through the ring without allocating
+struct ChessSearchProgress {
+    static constexpr int kMaxPV = 12;
+    static constexpr int kMaxLines = 4;
+    struct Line {
+        int score = 0;
+        int pvLength = 0;
+        BitMove pv[kMaxPV];
+    };
+    int depth = 0;
+    int score = 0;
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+    // best first, one unless an analysis asked for more. lines[0] is the move the search would play
+    int lineCount = 0;
+    Line lines[kMaxLines];
+};
+
 class Chess : public Game
 
 
@@ -15,26 +53,30 @@ public:
     ~Chess();
 
     PieceColor stateColor(int col, int row);
-    std::vector<BitMove> generateMoves(const char*state, char color);
-
 
-    void tryMove(std::string &state, int from, int to);
-    void undoMove(std::string &state, int from, int to, char capturedPiece);
-    int aiBoardEval(const std::string &state);
-    bool aiTestForTerminal(const std::string &state);
-    int negamax(std::string &state, int depth, int alpha, int beta, int playerColor);
     void updateAI() override;
+    void drawAIStatus() override;
+    // looks for the best lineCount moves for the side to move on the AI's search thread, drawAIStatus shows each
+    // with its score and line as the depths finish. the AI and the analysis share the search, so what one learns
+    // about the position the other gets to keep. stops the AI if it's thinking, and the AI's turn stops it
+    void analyze(int lineCount, SearchLimits limits);
+    // an index into chessDifficulties, takes effect from the AI's next move
+    void setDifficulty(int level) { _difficulty = std::clamp(level, 0, chessDifficultyCount - 1); }
+    int getDifficulty() const { return _difficulty; }
+    // the AI plays the same move every time in the same position: it searches to a node count, not a clock
+    void setReproducible(bool reproducible) { _reproducible = reproducible; }
+    // keep the AI's transposition table in this file between runs: read back now if it's there, saved whenever
+    // the game stops, so positions it has seen before start out already searched
+    void setTableFile(const std::string &path);
     bool checkForCheck(std::string& state, char playerColor);
     void setUpBoard() override;
-    void generatePawnMoves(const char *state, std::vector<BitMove>& moves, int row, int col, int colorInt);
-    void generateKnightMoves(const char *state, std::vector<BitMove>& moves, int row, int col, int colorInt);
-    void generateKingMoves(const char *state, std::vector<BitMove>& moves, int row, int col, int colorInt);
-    void generateBishopAndRookMoves(const char* state, std::vector<BitMove>& moves, int row, int col, int colorInt, int offsets[][2], int numOffsets);
-    void addMove(const char *state, std::vector<BitMove>&moves, int fromRow, int fromCol, int toRow, int toCol);
 
     bool canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
     bool actionForEmptyHolder(BitHolder &holder) override;
+    bool clickedBit(Bit &bit) override;
+    void clearBoardHighlights() override;
+    void endTurn() override;
 
     void stopGame() override;
 
@@ -48,46 +90,53 @@ public:
 
     Grid* getGrid() override { return _grid; }
 
-    // =================================================================
-    // move calculator for all pieces
-    // takes the move specified by the callable parameter getMove and the piece at the selected index.
-    // if the piece is a pawn, switchcase to perform special capture and movement logic.
-    // otherwise go to case for other pieces that just checks if the destination is empty or has an enemy piece before
-    // adding the move to the bitMove vector
-    // =================================================================
-    template<typename Getter>
-    void calculateMoves(const char *state, std::vector<BitMove>&moves, int row, int rowOffSet, int col, int colOffSet, int colorInt, Getter getMove)
-        {
-            char target = getMove();
-            char piece = state[row * 8 + col];
-            switch(toupper(static_cast<unsigned char>(piece))){
-                case 'P': 
-                    if(colOffSet == 0 && target == '0'){
-                        addMove(state, moves, row, col, row + rowOffSet, col + colOffSet);
-                        break;
-                    }
-                    if(colOffSet != 0 && target != '0'){
-                        addMove(state, moves, row, col, row + rowOffSet, col + colOffSet);
-                        break;
-                    }
-                    break;
-                case 'N' : case 'K' : case 'R' : case 'Q' : case 'B' :
-                    if (target == '0' || (target != '0' && ((colorInt == 1 && islower(static_cast<unsigned char>(target))) || (colorInt == -1 && isupper(static_cast<unsigned char>(target)))))){
-                        addMove(state, moves, row, col, row + rowOffSet, col + colOffSet);
-                    }
-                    break;
-            }
-        }
+    // place pieces on the board from the piece placement field of a FEN string
+    void FENtoBoard(const std::string& fen);
 
 private:
     Bit* PieceForPlayer(const int playerNumber, ChessPiece piece);
     Player* ownerAt(int x, int y) const;
     void pieceSetFEN(int col, int row, char FENchar, ChessPiece type);
-    void FENtoBoard(const std::string& fen);
     char pieceNotation(int x, int y) const;
+    // destinations of every legal move for color, one bitmask per from square
+    const uint64_t* legalTargets(char color);
+    // ends a search in progress and waits for its thread, throwing away what it found
+    void stopThinking();
+    // starts the search thread on the board as it is now, with color to move
+    void startSearch(int color, SearchLimits limits, bool analysis);
+    // the limits of the chosen difficulty
+    SearchLimits difficultyLimits() const;
     
     Grid* _grid;
 
+    // the legal moves are worked out once per position rather than on every drag test,
+    // for the side in _legalTargetsColor at board version _legalTargetsVersion
+    uint64_t _legalTargets[64];
+    char _legalTargetsColor = 0;
+    unsigned int _legalTargetsVersion = 0;
+    // squares showing a move hint, so clearing them doesn't touch the whole board
+    uint64_t _hintedSquares = 0;
+
     Bit* animatingPiece = nullptr;
+
+    // the AI searches on its own thread so the window keeps drawing. updateAI starts it and plays the move once
+    // _searchDone is set, _searchResult belongs to the search thread until then. _searchVersion is the board
+    // version it started from, if the board has changed since (undo, redo) the answer is thrown away
+    Search<ChessSearchTraits> _search;
+    std::thread _searchThread;
+    std::atomic<bool> _searchDone{false};
+    std::atomic<bool> _stopSearch{false};
+    SearchResult<BitMove> _searchResult;
+    unsigned int _searchVersion = 0;
+    // the search running or last run was an analysis, its move isn't played
+    bool _analyzing = false;
+    int _analysisLines = 3;
+    // empty unless setTableFile was called
+    std::string _tableFile;
+    int _difficulty = 2;
+    bool _reproducible = false;
+    // filled by the search thread, emptied by drawAIStatus every frame. _progress is the newest record read
+    SpscRing<ChessSearchProgress, 64> _progressRing;
+    ChessSearchProgress _progress;
     
 };
\ No newline at end of file
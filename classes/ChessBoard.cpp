@@ -0,0 +1,285 @@
+#include "ChessBoard.h"
+#include <array>
+#include <cmath>
+#include <string>
+#include <ctype.h>
+#include <cctype>
+
+using namespace std;
+
+// ==============================================================
+// global variables
+// ==============================================================
+
+static int bishopOffsets[4][2] = { {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+static int rookOffsets[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+// built at compile time so tools that never make a Chess game still evaluate correctly
+static constexpr array<int, 128> pieceValue = [] {
+    array<int, 128> values{};
+    values['P'] = 100; values['N'] = 320; values['B'] = 320; values['R'] = 500; values['Q'] = 900; values['K'] = 20000;
+    values['p'] = -100; values['n'] = -320; values['b'] = -320; values['r'] = -500; values['q'] = -900; values['k'] = -20000;
+    return values;
+}();
+
+// all move generation functionality basically operates the same, checking for a valid initial position before passing piece-specific offsets into
+// the calculate moves function template that utilizes callable parameter to apply the offsets
+// the offsets are locals so the search thread and the board can generate moves at the same time
+void ChessBoard::generatePawnMoves(const char *state, vector<BitMove>& moves, int row, int col, int colorInt) {
+    int rowOffset = (colorInt == 1) ? 1 : -1, colOffset = 0;
+    int startRow = (colorInt == 1) ? 1 : 6; 
+    // forward moves
+    if(row > 0 && row < 7){
+            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset) * 8 + (col + colOffset)]; });
+        // the double step needs the square in between empty too
+        if(row == startRow && state[(row + rowOffset) * 8 + col] == '0'){
+            rowOffset = rowOffset * 2;
+            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset) * 8 + (col + colOffset)]; });
+        }
+    }
+    // captures
+    if (col > 0) {
+        rowOffset = (colorInt == 1 ) ? 1 : -1; colOffset = -1;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset) * 8 + (col + colOffset)]; });
+    }
+    if (col < 7) {
+        rowOffset = (colorInt == 1 ) ? 1 : -1; colOffset = 1;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset) * 8 + (col + colOffset)]; });
+        }
+    }
+
+void ChessBoard::generateKnightMoves(const char *state, vector<BitMove>& moves, int row, int col, int colorInt) {
+    int rowOffset, colOffset;
+    if (row > 0 && col < 6){
+        rowOffset = -1; colOffset = 2;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row < 7 && col < 6){
+        rowOffset = 1; colOffset = 2;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row < 7 && col > 1){
+        rowOffset = 1; colOffset = -2;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row > 0 && col > 1){
+        rowOffset = -1; colOffset = -2;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row < 6 && col > 0){
+        rowOffset = 2; colOffset = -1;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row > 1 && col > 0){
+        rowOffset = -2; colOffset = -1;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row < 6 && col < 7){
+        rowOffset = 2; colOffset = 1;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row > 1 && col < 7){
+        rowOffset = -2; colOffset = 1;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+}
+
+void ChessBoard::generateKingMoves(const char *state, vector<BitMove>& moves, int row, int col, int colorInt) {
+    int rowOffset, colOffset;
+    // for my own reference, a row offset of 1 is a single space up towards the board. A col offset of 1 is one move to the right
+    if (row < 7){
+        rowOffset = 1; colOffset = 0;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row > 0){
+        rowOffset = -1; colOffset = 0;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (col > 0){
+        rowOffset = 0; colOffset = -1;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (col < 7){
+        rowOffset = 0; colOffset = 1;
+        calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    // diagonal moves
+    if (row >= 0 && row < 7 && col < 7){ 
+            rowOffset = 1; colOffset = 1;
+            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row > 0 && row <= 7 && col < 7){ 
+            rowOffset = -1; colOffset = 1;
+            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row >= 0 && row < 7 && col > 0){ 
+            rowOffset = 1; colOffset = -1;
+            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+    if (row > 0 && row <= 7 && col > 0){ 
+            rowOffset = -1; colOffset = -1;
+            calculateMoves(state, moves, row, rowOffset, col, colOffset, colorInt, [&]{ return state[(row + rowOffset ) * 8 + (col + colOffset)]; });
+    }
+}
+
+void ChessBoard::generateBishopAndRookMoves(const char* state, vector<BitMove>& moves, int row, int col, int colorInt, int offsets[][2], int numOffsets) {
+    for(int i = 0; i < numOffsets; i++) {
+        int rowOffset = offsets[i][0];
+        int colOffset = offsets[i][1];
+        int depth = 1;
+        while(true) {
+            
+            int rowIncrementValue = rowOffset * depth;
+            int colIncrementValue = colOffset * depth;
+            if(row + rowIncrementValue < 0 || row + rowIncrementValue  > 7 || col + colIncrementValue < 0 || col + colIncrementValue > 7) break;
+            calculateMoves(state, moves, row, rowIncrementValue, col, colIncrementValue, colorInt, [&]{ return state[ (row + rowIncrementValue) * 8 + (col + colIncrementValue)];});
+
+            char target = state[(row + rowIncrementValue) * 8 + (col + colIncrementValue)];
+            if (target != '0') break;
+            depth++;
+        }
+    }
+}
+
+void ChessBoard::addMove(const char *state, vector<BitMove>& moves, int fromRow, int fromCol, int toRow, int toCol) {
+    if(toRow >= 0 && toRow < 8 && toCol >= 0 && toCol < 8) {
+        char fromPiece = state[fromRow * 8 + fromCol];
+        char toPiece = state[toRow * 8 + toCol];
+        bool fromWhite = isupper(static_cast<unsigned char>(fromPiece)) != 0;
+        bool toWhite = isupper(static_cast<unsigned char>(toPiece)) != 0;
+
+        // empty destination or an enemy piece, never our own
+        if(toPiece == '0' || fromWhite != toWhite) {
+            moves.emplace_back(fromRow * 8 + fromCol, toRow * 8 + toCol, Knight);
+        }
+    }
+}
+
+vector<BitMove> ChessBoard::generateMoves(const char* state, char color) {
+    vector<BitMove> moves;
+    moves.reserve(40);
+
+    int colorInt = (color == 'W')  ? 1 : -1;
+
+    for(int i = 0; i < 64; i++) {
+        int row = i / 8;
+        int col = i % 8;
+        char piece = state[i];
+        int pieceColor = (piece == '0') ? 0 : (piece < 'a') ? 1 : -1;
+        if(pieceColor == colorInt){
+            if(toupper(static_cast<unsigned char>(piece)) == 'P') generatePawnMoves(state, moves, row, col, colorInt);
+            if(toupper(static_cast<unsigned char>(piece)) == 'N') generateKnightMoves(state, moves, row, col, colorInt);
+            if(toupper(static_cast<unsigned char>(piece)) == 'K') generateKingMoves(state, moves, row, col, colorInt);
+            if(toupper(static_cast<unsigned char>(piece)) == 'R') {
+                generateBishopAndRookMoves(state, moves, row, col, colorInt, rookOffsets, 4);
+            }
+            if(toupper(static_cast<unsigned char>(piece)) == 'B') {
+                generateBishopAndRookMoves(state, moves, row, col, colorInt, bishopOffsets, 4);
+            }
+            if(toupper(static_cast<unsigned char>(piece)) == 'Q') {
+                generateBishopAndRookMoves(state, moves, row, col, colorInt, rookOffsets, 4);
+                generateBishopAndRookMoves(state, moves, row, col, colorInt, bishopOffsets, 4);
+            }
+        }
+    }
+    return moves;
+}
+
+// ==================================================
+// AI Functions
+// ==================================================
+
+void ChessBoard::tryMove(string &state, int from, int to) {
+    state[to] = state[from];
+    state[from] = '0';
+}
+
+void ChessBoard::undoMove(string &state, int from, int to, char capturedPiece) {
+    state[from] = state[to];
+    state[to] = capturedPiece;
+}
+
+int ChessBoard::aiBoardEval(const char *state) {
+    // iterate through the state string and add score based on values designated to each piece in pieceValue look up table
+    // created in the constructor
+    int score = 0;
+    for (int i = 0; i < 64; i++) {
+        score += pieceValue[(int)state[i]];
+    }
+    return score;
+}
+
+
+bool ChessBoard::aiTestForTerminal(const char *state) {
+    bool whiteKing=false, blackKing=false;
+    for (int i = 0; i < 64; i++) {
+        if(state[i]=='K') whiteKing = true;
+        if(state[i]=='k') blackKing=true;
+    }
+    return !whiteKing || !blackKing;
+}
+
+// ==================================================
+// search traits
+// ==================================================
+
+ChessPosition ChessPosition::fromState(const string &state, int color) {
+    ChessPosition pos;
+    pos.color = color;
+    pos.key = (color == -1) ? sideKey() : 0;
+    for(int i = 0; i < 64; i++) {
+        pos.board[i] = state[i];
+        if(state[i] != '0') pos.key ^= pieceKey(i, state[i]);
+    }
+    return pos;
+}
+
+int ChessSearchTraits::generateMoves(const Position &pos, Move *moves) {
+    auto list = ChessBoard::generateMoves(pos.board, pos.color == 1 ? 'W' : 'B');
+    int count = min((int)list.size(), kMaxMoves);
+    copy(list.begin(), list.begin() + count, moves);
+    return count;
+}
+
+void ChessSearchTraits::makeMove(Position &pos, const Move &move, Undo &undo) {
+    char piece = pos.board[move.from];
+    undo.captured = pos.board[move.to];
+    pos.key ^= ChessPosition::pieceKey(move.from, piece) ^ ChessPosition::pieceKey(move.to, piece) ^ ChessPosition::sideKey();
+    if(undo.captured != '0') pos.key ^= ChessPosition::pieceKey(move.to, undo.captured);
+    pos.board[move.to] = piece;
+    pos.board[move.from] = '0';
+    pos.color = -pos.color;
+}
+
+void ChessSearchTraits::unmakeMove(Position &pos, const Move &move, const Undo &undo) {
+    char piece = pos.board[move.to];
+    pos.key ^= ChessPosition::pieceKey(move.from, piece) ^ ChessPosition::pieceKey(move.to, piece) ^ ChessPosition::sideKey();
+    if(undo.captured != '0') pos.key ^= ChessPosition::pieceKey(move.to, undo.captured);
+    pos.board[move.from] = piece;
+    pos.board[move.to] = undo.captured;
+    pos.color = -pos.color;
+}
+
+int ChessSearchTraits::evaluate(const Position &pos) {
+    return ChessBoard::aiBoardEval(pos.board) * pos.color;
+}
+
+bool ChessSearchTraits::isTerminal(const Position &pos, int &score) {
+    if(!ChessBoard::aiTestForTerminal(pos.board)) return false;
+    // a king was just taken, it is a loss for whoever owns the missing king
+    char ownKing = (pos.color == 1) ? 'K' : 'k';
+    bool ownKingAlive = false;
+    for(int i = 0; i < 64; i++) {
+        if(pos.board[i] == ownKing) ownKingAlive = true;
+    }
+    score = ownKingAlive ? SearchScore::kWin : -SearchScore::kWin;
+    return true;
+}
+
+// most valuable victim first, least valuable attacker breaking ties
+int ChessSearchTraits::orderScore(const Position &pos, const Move &move) {
+    char victim = pos.board[move.to];
+    if(victim == '0') return 0;
+    int victimValue = abs(pieceValue[(int)victim]);
+    int attackerValue = min(abs(pieceValue[(int)pos.board[move.from]]), 1000);
+    return victimValue * 64 + (1001 - attackerValue);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "Search.h"
+#include <cctype>
+#include <string>
+#include <vector>
+
+// =================================================================
+// search plumbing
+// a position is the usual 64 character state plus the side to move (1 white, -1 black)
+// and an incrementally updated hash key
+// =================================================================
+struct ChessPosition {
+    char board[64];
+    int color;
+    uint64_t key;
+
+    static ChessPosition fromState(const std::string &state, int color);
+    static uint64_t pieceKey(int square, char piece) { return zobristKey((uint64_t)square * 128 + (unsigned char)piece); }
+    static uint64_t sideKey() { return zobristKey(64 * 128); }
+};
+
+struct ChessSearchTraits {
+    using Position = ChessPosition;
+    using Move = BitMove;
+    struct Undo { char captured; };
+
+    static constexpr int kMaxMoves = 256;
+    static constexpr int kMoveIndexSize = 64 * 64;
+
+    static int generateMoves(const Position &pos, Move *moves);
+    static void makeMove(Position &pos, const Move &move, Undo &undo);
+    static void unmakeMove(Position &pos, const Move &move, const Undo &undo);
+    static int evaluate(const Position &pos);
+    static bool isTerminal(const Position &pos, int &score);
+    static int noMovesScore(const Position &pos) { return evaluate(pos); }
+    static uint64_t hash(const Position &pos) { return pos.key; }
+    static int orderScore(const Position &pos, const Move &move);
+    static int moveIndex(const Move &move) { return move.from * 64 + move.to; }
+};
+
+// =================================================================
+// the rules of chess on the 64 character state, with no board or sprites involved
+// this is what the Chess game, the search and any headless tools share
+// =================================================================
+class ChessBoard
+{
+public:
+    // move generation and evaluation only look at the 64 character state, never at the board,
+    // so the search can run them on positions it is exploring
+    static std::vector<BitMove> generateMoves(const char*state, char color);
+    static void tryMove(std::string &state, int from, int to);
+    static void undoMove(std::string &state, int from, int to, char capturedPiece);
+    static int aiBoardEval(const char *state);
+    static bool aiTestForTerminal(const char *state);
+    static void generatePawnMoves(const char *state, std::vector<BitMove>& moves, int row, int col, int colorInt);
+    static void generateKnightMoves(const char *state, std::vector<BitMove>& moves, int row, int col, int colorInt);
+    static void generateKingMoves(const char *state, std::vector<BitMove>& moves, int row, int col, int colorInt);
+    static void generateBishopAndRookMoves(const char* state, std::vector<BitMove>& moves, int row, int col, int colorInt, int offsets[][2], int numOffsets);
+    static void addMove(const char *state, std::vector<BitMove>&moves, int fromRow, int fromCol, int toRow, int toCol);
+
+    // =================================================================
+    // move calculator for all pieces
+    // takes the move specified by the callable parameter getMove and the piece at the selected index.
+    // if the piece is a pawn, switchcase to perform special capture and movement logic.
+    // otherwise go to case for other pieces that just checks if the destination is empty or has an enemy piece before
+    // adding the move to the bitMove vector
+    // =================================================================
+    template<typename Getter>
+    static void calculateMoves(const char *state, std::vector<BitMove>&moves, int row, int rowOffSet, int col, int colOffSet, int colorInt, Getter getMove)
+        {
+            char target = getMove();
+            char piece = state[row * 8 + col];
+            switch(toupper(static_cast<unsigned char>(piece))){
+                case 'P': 
+                    if(colOffSet == 0 && target == '0'){
+                        addMove(state, moves, row, col, row + rowOffSet, col + colOffSet);
+                        break;
+                    }
+                    if(colOffSet != 0 && target != '0'){
+                        addMove(state, moves, row, col, row + rowOffSet, col + colOffSet);
+                        break;
+                    }
+                    break;
+                case 'N' : case 'K' : case 'R' : case 'Q' : case 'B' :
+                    if (target == '0' || (target != '0' && ((colorInt == 1 && islower(static_cast<unsigned char>(target))) || (colorInt == -1 && isupper(static_cast<unsigned char>(target)))))){
+                        addMove(state, moves, row, col, row + rowOffSet, col + colOffSet);
+                    }
+                    break;
+            }
+        }
+};
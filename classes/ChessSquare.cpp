@@ -5,6 +5,7 @@ void ChessSquare::initHolder(const ImVec2 &position, const char *spriteName, con
 {
     _column = column;
     _row = row;
+    _moveHint = false;
     int odd = (column + row) % 2;
     ImVec4 color = odd ? ImVec4(0.93, 0.93, 0.84, 1.0) : ImVec4(0.48, 0.58, 0.36, 1.0);
     BitHolder::initHolder(position, color, spriteName);
@@ -50,12 +51,29 @@ bool ChessSquare::dropBitAtPoint(Bit *newbit, const ImVec2 &point)
 void ChessSquare::setHighlighted(bool highlighted)
 {
     Sprite::setHighlighted(highlighted);
+    updateColor();
+}
+
+void ChessSquare::setMoveHint(bool hint)
+{
+    if (hint != _moveHint)
+    {
+        _moveHint = hint;
+        updateColor();
+    }
+}
+
+void ChessSquare::updateColor()
+{
     int odd = (_column + _row) % 2;
     _color = odd ? ImVec4(0.93, 0.93, 0.84, 1.0) : ImVec4(0.48, 0.58, 0.36, 1.0);
-    if (highlighted)
+    if (_highlighted)
     {
         _color = odd ? ImVec4(0.48, 0.58, 0.36, 1.0) : ImVec4(0.93, 0.93, 0.84, 1.0);
         _color = Lerp(_color, ImVec4(0.75, 0.79, 0.30, 1.0), 0.75);
     }
+    else if (_moveHint)
+    {
+        _color = Lerp(_color, ImVec4(0.75, 0.79, 0.30, 1.0), 0.4);
+    }
 }
-
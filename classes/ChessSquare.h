@@ -19,6 +19,8 @@ public:
     std::string getNotation() { return _notation; }
     void setNotation(std::string notation) { _notation = notation; }
     void setHighlighted(bool highlight) override;
+    // a lighter tint than the highlight, for showing where a picked up piece can go
+    void setMoveHint(bool hint);
 
     int getDistance(const ChessSquare &other)
     {
@@ -32,11 +34,13 @@ public:
     int getSquareIndex() { return _row * 8 + _column; }
 
 private:
+    void updateColor();
     ImVec4 Lerp(ImVec4 a, ImVec4 b, float t)
     {
         return ImVec4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t);
     }
     int _column;
     int _row;
+    bool _moveHint = false;
     std::string _notation;
 };
@@ -1,10 +1,14 @@
 #include "Game.h"
 #include "Bit.h"
 #include "BitHolder.h"
-#include "Turn.h"
 #include "../Application.h"
 #include "Bitboard.h"
+#include "Profiler.h"
 #include <cmath>
+
+// shared by every game so a new game never starts on a version an old one used
+static unsigned int lastBoardVersion = 0;
+
 Game::Game()
 {
 	_gameOptions.AIPlayer = false;
@@ -17,6 +21,7 @@ Game::Game()
 	_gameOptions.score = 0;
 	_gameOptions.AIDepthSearches = 0;
 	_gameOptions.AIvsAI = false;
+	_boardVersion = 0;
 
 	_table = nullptr;
 	_winner = nullptr;
@@ -33,11 +38,6 @@ Game::Game()
 
 Game::~Game()
 {
-	for (auto &_turn : _turns)
-	{
-		delete _turn;
-	}
-	_turns.clear();
 	for (auto &_player : _players)
 	{
 		delete _player;
@@ -66,10 +66,6 @@ void Game::setNumberOfPlayers(unsigned int n)
 
 	_gameOptions.gameNumber = 0;
 	_gameOptions.numberOfPlayers = n;
-
-	Turn *turn = Turn::initStartOfGame(this);
-	_turns.clear();
-	_turns.push_back(turn);
 }
 
 void Game::setAIPlayer(unsigned int playerNumber)
@@ -81,26 +77,43 @@ void Game::setAIPlayer(unsigned int playerNumber)
 
 void Game::startGame()
 {
-	std::string startState = stateString();
-	Turn *turn = _turns.at(0);
-	turn->_boardState = startState;
-	turn->_gameNumber = _gameOptions.gameNumber;
+	_moveLog.reset(stateString());
 	_gameOptions.currentTurnNo = 0;
+	boardChanged();
+}
+
+void Game::boardChanged()
+{
+	_boardVersion = ++lastBoardVersion;
 }
 
 void Game::endTurn()
 {
+	boardChanged();
 	_gameOptions.currentTurnNo++;
-	std::string startState = stateString();
-	Turn *turn = new Turn;
-	turn->_boardState = stateString();
-	turn->_date = (int)_gameOptions.currentTurnNo;
-	turn->_score = _gameOptions.score;
-	turn->_gameNumber = _gameOptions.gameNumber;
-	_turns.push_back(turn);
+	_moveLog.record(stateString());
 	ClassGame::EndOfTurn();
 }
 
+void Game::undoTurn()
+{
+	seekTurn(_moveLog.current() - 1);
+}
+
+void Game::redoTurn()
+{
+	seekTurn(_moveLog.current() + 1);
+}
+
+//
+// puts the board back the way it was at the given turn, a new move from there drops the turns after it
+//
+void Game::seekTurn(int turn)
+{
+	setStateString(_moveLog.seek(turn));
+	_gameOptions.currentTurnNo = _moveLog.current();
+}
+
 //
 // scan for mouse is temporarily in the actual game class
 // this will be moved to a higher up class when the squares have a heirarchy
@@ -116,23 +129,23 @@ void Game::scanForMouse()
 #if defined(UCI_INTERFACE)
 	return;
 #endif
+	PROFILE_ZONE(ZoneScanForMouse);
 	ImVec2 mousePos = ImGui::GetMousePos();
 	mousePos.x -= ImGui::GetWindowPos().x;
 	mousePos.y -= ImGui::GetWindowPos().y;
 
+	// only the square under the cursor and the piece being dragged can be under it, however big the board is
 	Entity *entity = nullptr;
-	Grid* grid = getGrid();
-	grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
+	ChessSquare *square = getGrid()->squareAt(mousePos);
+	if (square)
+	{
 		Bit *bit = square->bit();
-		if (bit && bit->isMouseOver(mousePos))
-		{
-			entity = bit;
-		}
-		else if (square->isMouseOver(mousePos))
-		{
-			entity = square;
-		}
-	});
+		entity = (bit && bit->isMouseOver(mousePos)) ? (Entity *)bit : (Entity *)square;
+	}
+	if (_dragBit && _dragBit->isMouseOver(mousePos))
+	{
+		entity = _dragBit;
+	}
 	if (ImGui::IsMouseClicked(0))
 	{
 		mouseDown(mousePos, entity);
@@ -149,68 +162,67 @@ void Game::scanForMouse()
 
 void Game::findDropTarget(ImVec2 &pos)
 {
-	Grid* grid = getGrid();
-	grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-		if (square == _oldHolder)
-		{
-			return;
-		}
-		if (square->isMouseOver(pos))
+	ChessSquare *square = getGrid()->squareAt(pos);
+	if (!square || square == _oldHolder)
+	{
+		return;
+	}
+	if (_dropTarget && square != _dropTarget)
+	{
+		_dropTarget->willNotDropBit(_dragBit);
+		_dropTarget->setHighlighted(false);
+		_dropTarget = nullptr;
+	}
+	if (_oldHolder && square->canDropBitAtPoint(_dragBit, pos))
+	{
+		PROFILE_ZONE(ZoneCanBitMoveFromTo);
+		if (canBitMoveFromTo(*_dragBit, *_oldHolder, *square))
 		{
-			if (_dropTarget && square != _dropTarget)
-			{
-				_dropTarget->willNotDropBit(_dragBit);
-				_dropTarget->setHighlighted(false);
-				_dropTarget = nullptr;
-			}
-			if (_oldHolder && square->canDropBitAtPoint(_dragBit, pos) && canBitMoveFromTo(*_dragBit, *_oldHolder, *square))
-			{
-				_dropTarget = square;
-				_dropTarget->setHighlighted(true);
-			}
+			_dropTarget = square;
+			_dropTarget->setHighlighted(true);
 		}
-	});
+	}
 }
 
 //
 // draw the board and then the pieces
-// this will also go somewhere else when the heirarchy is set up
+// one pass over the grid collects every sprite into its layer, then the batch draws them all at once
 //
 void Game::drawFrame()
 {
 	scanForMouse();
 
-	Grid* grid = getGrid();
-
-	// Paint squares
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		square->paintSprite();
-	});
-
-	// Paint stationary pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && !square->bit()->getPickedUp() && !square->bit()->getMoving())
-		{
-			square->bit()->paintSprite();
-		}
-	});
-
-	// Paint moving pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && square->bit()->getMoving() && !square->bit()->getPickedUp())
-		{
-			square->bit()->update();
-			square->bit()->paintSprite();
-		}
-	});
+	{
+		PROFILE_ZONE(ZoneDrawCollect);
+		_spriteBatch.clear();
+		// only the bits that are sliding get touched, the rest just get drawn
+		Animation::update();
+		getGrid()->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
+			_spriteBatch.add(*square, SpriteBatch::LayerBoard);
+			Bit *bit = square->bit();
+			if (!bit)
+			{
+				return;
+			}
+			if (bit->getPickedUp())
+			{
+				_spriteBatch.add(*bit, SpriteBatch::LayerPickedUp);
+			}
+			else if (bit->getMoving())
+			{
+				_spriteBatch.add(*bit, SpriteBatch::LayerMoving);
+			}
+			else
+			{
+				_spriteBatch.add(*bit, SpriteBatch::LayerPieces);
+			}
+		});
+	}
 
-	// Paint picked up pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && square->bit()->getPickedUp())
-		{
-			square->bit()->paintSprite();
-		}
-	});
+	{
+		PROFILE_ZONE(ZoneDrawSubmit);
+		_spriteBatch.submit();
+	}
 }
 
 void Game::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
@@ -18,10 +18,13 @@
 #endif
 
 #include "Player.h"
-#include "Turn.h"
+#include "MoveLog.h"
 #include "Bit.h"
 #include "BitHolder.h"
+#include "BitPool.h"
+#include "Animation.h"
 #include "Grid.h"
+#include "SpriteBatch.h"
 
 
 const int AI_PLAYER = 1;
@@ -55,6 +58,8 @@ public:
 	virtual void setUpBoard() = 0;
 
 	virtual void drawFrame();
+	// a piece is sliding into place or being dragged, so the board keeps changing without any input
+	bool isAnimating() const { return Animation::active() || _dragBit != nullptr; }
 
 	// end the current game turn
 	virtual void endTurn();
@@ -95,6 +100,8 @@ public:
 	virtual void stopGame() = 0;
 	virtual bool gameHasAI();
 	virtual void updateAI();
+	// the AI's part of the Settings window, its options and what it's thinking, called every frame
+	virtual void drawAIStatus(){};
 	virtual void pieceTaken(Bit *bit){};
 
 	virtual std::string initialStateString() = 0;
@@ -128,11 +135,23 @@ public:
 		else
 			return 1;
 	};
+	// turn history, restoring a turn goes through setStateString
+	const MoveLog &moveLog() const { return _moveLog; }
+	bool canUndoTurn() const { return _moveLog.canUndo(); }
+	bool canRedoTurn() const { return _moveLog.canRedo(); }
+	void undoTurn();
+	void redoTurn();
+	void seekTurn(int turn);
+
+	// moves on whenever the pieces on the board change, so anything worked out from the board can keep its
+	// answer and redo it only when this is different. versions are never reused, not even by the next game
+	unsigned int boardVersion() const { return _boardVersion; }
+
 	GameTable *_table;
 	Player *_winner;
 
 	std::vector<Player *> _players;
-	std::vector<Turn *> _turns;
+	MoveLog _moveLog;
 
 	std::string _lastMove;
 
@@ -143,6 +162,8 @@ protected:
 	void mouseMoved(ImVec2 &location, Entity *bit);
 	void mouseUp(ImVec2 &location, Entity *bit);
 	void findDropTarget(ImVec2 &pos);
+	// every change to the board outside of a turn ending calls this, setting up and setStateString
+	void boardChanged();
 
 	ImVec2 _dragStartPos;
 	ImVec2 _dragOffset;
@@ -152,4 +173,12 @@ protected:
 	BitHolder *_dropTarget;
 	BitHolder *_oldHolder;
 	bool _dragMoved;
+
+	// reused every frame by drawFrame
+	SpriteBatch _spriteBatch;
+	// every piece the game creates comes from here
+	BitPool _bitPool;
+
+private:
+	unsigned int _boardVersion;
 };
@@ -1,35 +1,25 @@
 #include "Grid.h"
+#include <algorithm>
 
-Grid::Grid(int width, int height) : _width(width), _height(height)
+Grid::Grid(int width, int height) : _width(width), _height(height), _origin(0, 0), _squareSize(0), _bottomUp(false)
 {
-    // Initialize 2D vectors
-    _squares.resize(height);
-    _enabled.resize(height);
-
-    for (int y = 0; y < height; y++) {
-        _squares[y].resize(width);
-        _enabled[y].resize(width);
-
-        for (int x = 0; x < width; x++) {
-            _squares[y][x] = new ChessSquare();
-            _enabled[y][x] = true; // All squares enabled by default
-        }
+    int count = width * height;
+    _squares = std::make_unique<ChessSquare[]>(count);
+    // All squares enabled by default, the bits past the last square stay clear
+    _enabled.assign((count + 63) / 64, ~0ull);
+    if (count % 64) {
+        _enabled.back() = (1ull << (count % 64)) - 1;
     }
 }
 
 Grid::~Grid()
 {
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            delete _squares[y][x];
-        }
-    }
 }
 
 ChessSquare* Grid::getSquare(int x, int y)
 {
     if (!isValid(x, y)) return nullptr;
-    return _squares[y][x];
+    return &_squares[getIndex(x, y)];
 }
 
 ChessSquare* Grid::getSquareByIndex(int index)
@@ -47,13 +37,17 @@ bool Grid::isValid(int x, int y) const
 bool Grid::isEnabled(int x, int y) const
 {
     if (!isValid(x, y)) return false;
-    return _enabled[y][x];
+    return enabledAt(getIndex(x, y));
 }
 
 void Grid::setEnabled(int x, int y, bool enabled)
 {
     if (isValid(x, y)) {
-        _enabled[y][x] = enabled;
+        int index = getIndex(x, y);
+        if (enabled)
+            _enabled[index >> 6] |= 1ull << (index & 63);
+        else
+            _enabled[index >> 6] &= ~(1ull << (index & 63));
     }
 }
 
@@ -149,27 +143,6 @@ bool Grid::areConnected(int fromX, int fromY, int toX, int toY)
     return false;
 }
 
-// Iterator support
-void Grid::forEachSquare(std::function<void(ChessSquare*, int x, int y)> func)
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            func(_squares[y][x], x, y);
-        }
-    }
-}
-
-void Grid::forEachEnabledSquare(std::function<void(ChessSquare*, int x, int y)> func)
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            if (_enabled[y][x]) {
-                func(_squares[y][x], x, y);
-            }
-        }
-    }
-}
-
 // Initialize squares
 void Grid::initializeSquares(float squareSize, const char* spriteName)
 {
@@ -183,10 +156,13 @@ void Grid::initializeSquares(float squareSize, const char* spriteName)
 // chess board starts at bottom a1 = 0,0
 void Grid::initializeChessSquares(float squareSize, const char* spriteName)
 {
+    _origin = ImVec2(squareSize/2, squareSize/2);
+    _squareSize = squareSize;
+    _bottomUp = true;
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
             ImVec2 position(squareSize * x + squareSize/2, squareSize * (7-y) + squareSize/2);
-            _squares[y][x]->initHolder(position, spriteName, x, y);
+            getSquare(x, y)->initHolder(position, spriteName, x, y);
         }
     }
 }
@@ -194,11 +170,29 @@ void Grid::initializeChessSquares(float squareSize, const char* spriteName)
 void Grid::initializeSquare(int x, int y, float squareSize, const char* spriteName)
 {
     if (isValid(x, y)) {
+        _origin = ImVec2(squareSize/2, squareSize/2);
+        _squareSize = squareSize;
+        _bottomUp = false;
         ImVec2 position(squareSize * x + squareSize/2, squareSize * y + squareSize/2);
-        _squares[y][x]->initHolder(position, spriteName, x, y);
+        ChessSquare* square = getSquare(x, y);
+        square->initHolder(position, spriteName, x, y);
+        square->setSize(squareSize, squareSize);
     }
 }
 
+ChessSquare* Grid::squareAt(const ImVec2& point)
+{
+    if (_squareSize <= 0) return nullptr;
+    float column = (point.x - _origin.x) / _squareSize;
+    float row = (point.y - _origin.y) / _squareSize;
+    // checked before converting so points far off the board can't overflow the int
+    if (column < 0 || column >= _width || row < 0 || row >= _height) return nullptr;
+    int x = (int)column;
+    int y = _bottomUp ? _height - 1 - (int)row : (int)row;
+    int index = getIndex(x, y);
+    return enabledAt(index) ? &_squares[index] : nullptr;
+}
+
 // State management
 std::string Grid::getStateString() const
 {
@@ -206,8 +200,9 @@ std::string Grid::getStateString() const
 
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
-            if (_enabled[y][x]) {
-                Bit* bit = _squares[y][x]->bit();
+            int index = getIndex(x, y);
+            if (enabledAt(index)) {
+                Bit* bit = _squares[index].bit();
                 if (bit) {
                     state += std::to_string(bit->gameTag());
                 } else {
@@ -226,11 +221,11 @@ void Grid::setStateString(const std::string& state)
 
     for (int y = 0; y < _height && index < state.length(); y++) {
         for (int x = 0; x < _width && index < state.length(); x++) {
-            if (_enabled[y][x]) {
+            if (isEnabled(x, y)) {
                 char pieceChar = state[index++];
 
                 // Clear existing piece
-                _squares[y][x]->destroyBit();
+                getSquare(x, y)->destroyBit();
 
                 // This method just sets the state - games need to create their own pieces
                 // when loading from state string based on the piece type
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "ChessSquare.h"
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <unordered_map>
-#include <functional>
 #include <string>
 
 class Grid
@@ -49,23 +50,55 @@ public:
     std::vector<ChessSquare*> getConnectedSquares(int x, int y);
     bool areConnected(int fromX, int fromY, int toX, int toY);
 
-    // Iterator support
-    void forEachSquare(std::function<void(ChessSquare*, int x, int y)> func);
-    void forEachEnabledSquare(std::function<void(ChessSquare*, int x, int y)> func);
+    // Iterator support, func is called as func(ChessSquare*, int x, int y) in index order
+    template <typename Func>
+    void forEachSquare(Func &&func)
+    {
+        ChessSquare* square = _squares.get();
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++, square++) {
+                func(square, x, y);
+            }
+        }
+    }
+
+    template <typename Func>
+    void forEachEnabledSquare(Func &&func)
+    {
+        int index = 0;
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++, index++) {
+                if (enabledAt(index)) {
+                    func(&_squares[index], x, y);
+                }
+            }
+        }
+    }
 
     // Initialize squares with positions and sprites
     void initializeChessSquares(float squareSize, const char* spriteName);
     void initializeSquares(float squareSize, const char* spriteName);
     void initializeSquare(int x, int y, float squareSize, const char* spriteName);
 
+    // the enabled square under a window-local point, worked out from the layout the initializers used
+    // rather than by testing squares, nullptr off the board or before the squares are initialized
+    ChessSquare* squareAt(const ImVec2& point);
+
     // State management (for enabled squares only)
     std::string getStateString() const;
     void setStateString(const std::string& state);
 
 private:
-    std::vector<std::vector<ChessSquare*>> _squares;
-    std::vector<std::vector<bool>> _enabled;
+    bool enabledAt(int index) const { return (_enabled[index >> 6] >> (index & 63)) & 1; }
+
+    // all of the squares in one block, row by row, and one enabled bit per square in the same order
+    std::unique_ptr<ChessSquare[]> _squares;
+    std::vector<uint64_t> _enabled;
     std::unordered_map<int, std::vector<int>> _connections;
     int _width;
     int _height;
+    // top left corner of the board, the square size, and whether row 0 is drawn at the bottom
+    ImVec2 _origin;
+    float _squareSize;
+    bool _bottomUp;
 };
\ No newline at end of file
@@ -0,0 +1,405 @@
+#include "MNKBoard.h"
+#include "Bitboard.h"
+#include <algorithm>
+
+// boards up to this many cells are searched over every empty cell, larger ones only near the stones
+static const int kFullWidthCells = 25;
+// cells this many steps from a stone are move candidates
+static const int kNeighborRadius = 2;
+// a win on the board for whoever moves next, or two open wins for the opponent, is as good as decided
+static const int kDecided = 100000;
+
+bool MNKBits::any() const
+{
+    for (int i = 0; i < kWords; i++)
+    {
+        if (words[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int MNKBits::count() const
+{
+    int count = 0;
+    for (int i = 0; i < kWords; i++)
+    {
+        count += popCount64(words[i]);
+    }
+    return count;
+}
+
+int MNKBits::first() const
+{
+    for (int i = 0; i < kWords; i++)
+    {
+        if (words[i])
+        {
+            return i * 64 + bitScanForward64(words[i]);
+        }
+    }
+    return -1;
+}
+
+int MNKBits::collect(int *out) const
+{
+    int count = 0;
+    for (int i = 0; i < kWords; i++)
+    {
+        for (uint64_t word = words[i]; word; word &= word - 1)
+        {
+            out[count++] = i * 64 + bitScanForward64(word);
+        }
+    }
+    return count;
+}
+
+std::shared_ptr<const MNKBoard::Shape> MNKBoard::makeShape(int width, int height, int inARow)
+{
+    auto shape = std::make_shared<Shape>();
+    shape->width = std::clamp(width, 3, kMaxSide);
+    shape->height = std::clamp(height, 3, kMaxSide);
+    shape->inARow = std::clamp(inARow, 3, std::min(shape->width, shape->height));
+    shape->cells = shape->width * shape->height;
+    width = shape->width;
+    height = shape->height;
+    inARow = shape->inARow;
+
+    // windows start on every cell from which k steps stay on the board: across, down, and both diagonals
+    static const int kDirections[4][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+    std::vector<std::vector<uint16_t>> windowsOf(shape->cells);
+    shape->windows = 0;
+    for (const auto &direction : kDirections)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int endX = x + direction[0] * (inARow - 1);
+                int endY = y + direction[1] * (inARow - 1);
+                if (endX < 0 || endX >= width || endY >= height)
+                {
+                    continue;
+                }
+                for (int i = 0; i < inARow; i++)
+                {
+                    int cell = (y + direction[1] * i) * width + x + direction[0] * i;
+                    shape->windowCells.push_back((uint16_t)cell);
+                    windowsOf[cell].push_back((uint16_t)shape->windows);
+                }
+                shape->windows++;
+            }
+        }
+    }
+    for (int cell = 0; cell < shape->cells; cell++)
+    {
+        shape->cellWindowStart.push_back((int)shape->cellWindows.size());
+        shape->cellWindows.insert(shape->cellWindows.end(), windowsOf[cell].begin(), windowsOf[cell].end());
+    }
+    shape->cellWindowStart.push_back((int)shape->cellWindows.size());
+
+    for (int cell = 0; cell < shape->cells; cell++)
+    {
+        shape->neighborStart.push_back((int)shape->neighbors.size());
+        int x = cell % width;
+        int y = cell / width;
+        for (int ny = std::max(0, y - kNeighborRadius); ny <= std::min(height - 1, y + kNeighborRadius); ny++)
+        {
+            for (int nx = std::max(0, x - kNeighborRadius); nx <= std::min(width - 1, x + kNeighborRadius); nx++)
+            {
+                if (nx != x || ny != y)
+                {
+                    shape->neighbors.push_back((uint16_t)(ny * width + nx));
+                }
+            }
+        }
+    }
+    shape->neighborStart.push_back((int)shape->neighbors.size());
+
+    // bit 0 mirrors x, bit 1 mirrors y, bit 2 swaps the axes, which only keeps a square board on itself
+    shape->symmetries = width == height ? 8 : 4;
+    shape->symmetricCell.resize(shape->symmetries * shape->cells);
+    for (int symmetry = 0; symmetry < shape->symmetries; symmetry++)
+    {
+        for (int cell = 0; cell < shape->cells; cell++)
+        {
+            int x = cell % width;
+            int y = cell / width;
+            if (symmetry & 1)
+                x = width - 1 - x;
+            if (symmetry & 2)
+                y = height - 1 - y;
+            if (symmetry & 4)
+                std::swap(x, y);
+            shape->symmetricCell[symmetry * shape->cells + cell] = (uint16_t)(y * width + x);
+        }
+    }
+
+    // each stone in an open window is worth eight times the one before, capped so long lines can't overflow
+    shape->weights.assign(inARow + 1, 0);
+    for (int stones = 1; stones < inARow; stones++)
+    {
+        shape->weights[stones] = 1 << std::min(3 * (stones - 1), 20);
+    }
+    return shape;
+}
+
+MNKBoard::MNKBoard(int width, int height, int inARow) : _shape(makeShape(width, height, inARow))
+{
+    _cells.assign(_shape->cells, 0);
+    _windowCounts.assign(_shape->windows * 2, 0);
+    for (int side = 0; side < 2; side++)
+    {
+        _winCounts[side].assign(_shape->cells, 0);
+        _fourCounts[side].assign(_shape->cells, 0);
+    }
+    _nearCounts.assign(_shape->cells, 0);
+}
+
+void MNKBoard::countThreat(std::vector<uint8_t> &counts, MNKBits &bits, int cell, int sign)
+{
+    counts[cell] += sign;
+    if (counts[cell] == 0)
+        bits.clear(cell);
+    else
+        bits.set(cell);
+}
+
+//
+// adds (sign +1) or takes back (sign -1) what a window contributes to the scores and the threat counts.
+// only windows holding one side's stones count, and only the ones a stone or two short of a line are threats
+//
+void MNKBoard::markWindow(int window, int sign)
+{
+    const uint8_t *counts = &_windowCounts[window * 2];
+    for (int side = 0; side < 2; side++)
+    {
+        int own = counts[side];
+        if (own == 0 || counts[1 - side] != 0)
+        {
+            continue;
+        }
+        _score[side] += sign * _shape->weights[own];
+
+        int missing = _shape->inARow - own;
+        if (missing < 1 || missing > 2)
+        {
+            continue;
+        }
+        const uint16_t *cells = &_shape->windowCells[window * _shape->inARow];
+        for (int i = 0; i < _shape->inARow; i++)
+        {
+            if (_cells[cells[i]] == 0)
+            {
+                if (missing == 1)
+                    countThreat(_winCounts[side], _winBits[side], cells[i], sign);
+                else
+                    countThreat(_fourCounts[side], _fourBits[side], cells[i], sign);
+            }
+        }
+    }
+}
+
+void MNKBoard::place(int cell, int side)
+{
+    const Shape &shape = *_shape;
+    const uint16_t *windows = &shape.cellWindows[shape.cellWindowStart[cell]];
+    int windowCount = shape.cellWindowStart[cell + 1] - shape.cellWindowStart[cell];
+
+    for (int i = 0; i < windowCount; i++)
+    {
+        markWindow(windows[i], -1);
+    }
+    _cells[cell] = (uint8_t)(side + 1);
+    _occupied.set(cell);
+    _stones++;
+    for (int i = 0; i < windowCount; i++)
+    {
+        if (++_windowCounts[windows[i] * 2 + side] == shape.inARow)
+        {
+            _winner = side;
+        }
+        markWindow(windows[i], +1);
+    }
+
+    for (int i = shape.neighborStart[cell]; i < shape.neighborStart[cell + 1]; i++)
+    {
+        int neighbor = shape.neighbors[i];
+        if (_nearCounts[neighbor]++ == 0)
+        {
+            _near.set(neighbor);
+        }
+    }
+    for (int symmetry = 0; symmetry < shape.symmetries; symmetry++)
+    {
+        _hashes[symmetry] ^= zobristKey(shape.symmetricCell[symmetry * shape.cells + cell] * 2 + side);
+    }
+}
+
+void MNKBoard::remove(int cell)
+{
+    const Shape &shape = *_shape;
+    const uint16_t *windows = &shape.cellWindows[shape.cellWindowStart[cell]];
+    int windowCount = shape.cellWindowStart[cell + 1] - shape.cellWindowStart[cell];
+    int side = _cells[cell] - 1;
+
+    for (int i = 0; i < windowCount; i++)
+    {
+        markWindow(windows[i], -1);
+    }
+    _cells[cell] = 0;
+    _occupied.clear(cell);
+    _stones--;
+    _winner = -1;
+    for (int i = 0; i < windowCount; i++)
+    {
+        _windowCounts[windows[i] * 2 + side]--;
+        markWindow(windows[i], +1);
+    }
+
+    for (int i = shape.neighborStart[cell]; i < shape.neighborStart[cell + 1]; i++)
+    {
+        int neighbor = shape.neighbors[i];
+        if (--_nearCounts[neighbor] == 0)
+        {
+            _near.clear(neighbor);
+        }
+    }
+    for (int symmetry = 0; symmetry < shape.symmetries; symmetry++)
+    {
+        _hashes[symmetry] ^= zobristKey(shape.symmetricCell[symmetry * shape.cells + cell] * 2 + side);
+    }
+}
+
+int MNKBoard::generateMoves(int *moves) const
+{
+    int side = toMove();
+    if (_winBits[side].any())
+    {
+        moves[0] = _winBits[side].first();
+        return 1;
+    }
+    // anything but a block loses on the spot, and two wins to block lose anyway
+    if (_winBits[1 - side].any())
+    {
+        return _winBits[1 - side].collect(moves);
+    }
+
+    int count = 0;
+    if (_shape->cells <= kFullWidthCells)
+    {
+        for (int cell = 0; cell < _shape->cells; cell++)
+        {
+            if (_cells[cell] == 0)
+            {
+                moves[count++] = cell;
+            }
+        }
+        return count;
+    }
+    if (_stones == 0)
+    {
+        moves[0] = (_shape->height / 2) * _shape->width + _shape->width / 2;
+        return 1;
+    }
+    MNKBits candidates;
+    for (int i = 0; i < MNKBits::kWords; i++)
+    {
+        candidates.words[i] = _near.words[i] & ~_occupied.words[i];
+    }
+    return candidates.collect(moves);
+}
+
+int MNKBoard::evaluate() const
+{
+    int side = toMove();
+    if (_winBits[side].any())
+    {
+        return kDecided;
+    }
+    if (_winBits[1 - side].count() >= 2)
+    {
+        return -kDecided;
+    }
+    return _score[side] - _score[1 - side];
+}
+
+int MNKBoard::orderScore(int cell) const
+{
+    int side = toMove();
+    return _fourCounts[side][cell] * 4 + _fourCounts[1 - side][cell] * 3;
+}
+
+uint64_t MNKBoard::hash() const
+{
+    uint64_t key = _hashes[0];
+    for (int symmetry = 1; symmetry < _shape->symmetries; symmetry++)
+    {
+        key = std::min(key, _hashes[symmetry]);
+    }
+    return key;
+}
+
+bool MNKBoard::findForcedWin(int depth, int budget, int &move)
+{
+    return fourChain(depth, budget, move);
+}
+
+bool MNKBoard::fourChain(int depth, int &budget, int &move)
+{
+    int attacker = toMove();
+    int defender = 1 - attacker;
+    if (_winBits[attacker].any())
+    {
+        move = _winBits[attacker].first();
+        return true;
+    }
+    // a four of the defender's would have to be blocked first, which is outside this search
+    if (depth <= 0 || --budget < 0 || _winBits[defender].any())
+    {
+        return false;
+    }
+
+    int candidates[kMaxCells];
+    int count = _fourBits[attacker].collect(candidates);
+    for (int i = 0; i < count && budget >= 0; i++)
+    {
+        int cell = candidates[i];
+        place(cell, attacker);
+        // the defender had no wins to play first, so two wins for the attacker can't both be stopped
+        bool won = _winBits[attacker].count() >= 2;
+        if (!won)
+        {
+            int block = _winBits[attacker].first();
+            int reply;
+            place(block, defender);
+            won = fourChain(depth - 1, budget, reply);
+            remove(block);
+        }
+        remove(cell);
+        if (won)
+        {
+            move = cell;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MNKSearchTraits::isTerminal(const Position &pos, int &score)
+{
+    // a line is only ever completed by the player who just moved
+    if (pos.winner() >= 0)
+    {
+        score = -SearchScore::kWin;
+        return true;
+    }
+    if (pos.full())
+    {
+        score = 0;
+        return true;
+    }
+    return false;
+}
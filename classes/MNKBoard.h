@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Search.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//
+// m,n,k game core: k in a row on a width x height board, tic tac toe is 3,3,3 and gomoku 15,15,5 or 19,19,5
+// cell index is y * width + x, the same order as the state string. every run of k cells along a row, column
+// or diagonal is a window and the board keeps a stone count per side for each one, so a move only touches
+// the windows through its cell. from those counts it keeps, per side, the empty cells that would complete
+// a line (wins) and the ones that would leave the side a single stone short (fours), which drive the forced
+// move generation, the move ordering and the threat-space search.
+//
+struct MNKBits
+{
+    static constexpr int kWords = 6;
+
+    uint64_t words[kWords] = {};
+
+    void set(int bit) { words[bit >> 6] |= 1ull << (bit & 63); }
+    void clear(int bit) { words[bit >> 6] &= ~(1ull << (bit & 63)); }
+    bool test(int bit) const { return (words[bit >> 6] >> (bit & 63)) & 1; }
+    bool any() const;
+    int  count() const;
+    // lowest set bit, the set must not be empty
+    int  first() const;
+    // writes the set bits to out in increasing order, returns how many
+    int  collect(int *out) const;
+};
+
+class MNKBoard
+{
+public:
+    static constexpr int kMaxSide = 19;
+    static constexpr int kMaxCells = kMaxSide * kMaxSide;
+
+    // inARow is clamped to 3..min(width, height)
+    MNKBoard(int width = 3, int height = 3, int inARow = 3);
+
+    int  width() const { return _shape->width; }
+    int  height() const { return _shape->height; }
+    int  inARow() const { return _shape->inARow; }
+    int  cells() const { return _shape->cells; }
+
+    // -1 for an empty cell, otherwise the side whose stone is on it
+    int  stoneAt(int cell) const { return _cells[cell] - 1; }
+    int  stones() const { return _stones; }
+    // the first player moves whenever the stone count is even
+    int  toMove() const { return _stones & 1; }
+    // the side that completed a line, -1 while nobody has
+    int  winner() const { return _winner; }
+    bool full() const { return _stones == _shape->cells; }
+
+    void place(int cell, int side);
+    // lines are only ever completed by the last stone placed, so taking any stone clears the winner
+    void remove(int cell);
+    void play(int cell) { place(cell, toMove()); }
+
+    // empty cells that complete a line for side, and the ones that leave it a stone short of one
+    const MNKBits &wins(int side) const { return _winBits[side]; }
+    const MNKBits &fours(int side) const { return _fourBits[side]; }
+
+    // a winning cell if there is one, otherwise every cell that blocks the opponent's wins, otherwise the empty
+    // cells near the stones. small boards list every empty cell
+    int      generateMoves(int *moves) const;
+    // from the side to move's point of view
+    int      evaluate() const;
+    // > 0 for moves that make or block fours
+    int      orderScore(int cell) const;
+    // the same for every rotation and reflection of the position, so symmetric positions share table entries.
+    // the side to move follows from the stone count and needs no key of its own
+    uint64_t hash() const;
+
+    //
+    // threat-space search over fours: the side to move makes fours, each forcing the one reply that blocks it,
+    // until a four can't be blocked. every step is forced so a success is a proven win, move is its first stone.
+    // depth is the most fours in the chain and budget the nodes it may visit
+    //
+    bool     findForcedWin(int depth, int budget, int &move);
+
+private:
+    // everything that only depends on width, height and k, shared by copies of the board
+    struct Shape
+    {
+        int width;
+        int height;
+        int inARow;
+        int cells;
+        int windows;
+        // inARow cells per window
+        std::vector<uint16_t> windowCells;
+        // the windows through each cell, cellWindows[cellWindowStart[cell]] up to cellWindowStart[cell + 1]
+        std::vector<int>      cellWindowStart;
+        std::vector<uint16_t> cellWindows;
+        // cells within two steps, the ones worth playing once the cell is taken
+        std::vector<int>      neighborStart;
+        std::vector<uint16_t> neighbors;
+        // the cell each one maps to under each rotation or reflection, 8 of them on square boards and 4 otherwise
+        int                   symmetries;
+        std::vector<uint16_t> symmetricCell;
+        // score of a window holding only one side's stones, by how many
+        std::vector<int>      weights;
+    };
+
+    static std::shared_ptr<const Shape> makeShape(int width, int height, int inARow);
+
+    void markWindow(int window, int sign);
+    void countThreat(std::vector<uint8_t> &counts, MNKBits &bits, int cell, int sign);
+    bool fourChain(int depth, int &budget, int &move);
+
+    std::shared_ptr<const Shape> _shape;
+
+    // 0 for empty, side + 1 for a stone
+    std::vector<uint8_t> _cells;
+    // stones of each side in each window, two per window
+    std::vector<uint8_t> _windowCounts;
+    // per side, how many windows each empty cell would complete or bring to a four
+    std::vector<uint8_t> _winCounts[2];
+    std::vector<uint8_t> _fourCounts[2];
+    MNKBits              _winBits[2];
+    MNKBits              _fourBits[2];
+    // stones within two steps of each cell
+    std::vector<uint8_t> _nearCounts;
+    MNKBits              _near;
+    MNKBits              _occupied;
+
+    int                  _stones = 0;
+    int                  _winner = -1;
+    // sum of the window weights for each side
+    int                  _score[2] = {};
+    // zobrist key of the position seen through each symmetry
+    uint64_t             _hashes[8] = {};
+};
+
+//
+// search plumbing, the board is the whole position
+//
+struct MNKSearchTraits
+{
+    using Position = MNKBoard;
+    using Move = int;
+    struct Undo {};
+
+    static constexpr int kMaxMoves = MNKBoard::kMaxCells;
+    static constexpr int kMoveIndexSize = MNKBoard::kMaxCells;
+
+    static int      generateMoves(const Position &pos, Move *moves) { return pos.generateMoves(moves); }
+    static void     makeMove(Position &pos, const Move &move, Undo &undo) { pos.play(move); }
+    static void     unmakeMove(Position &pos, const Move &move, const Undo &undo) { pos.remove(move); }
+    static int      evaluate(const Position &pos) { return pos.evaluate(); }
+    static bool     isTerminal(const Position &pos, int &score);
+    static int      noMovesScore(const Position &pos) { return 0; }
+    // symmetric positions share an entry, so a hash move found through one can be another cell in this one.
+    // it is only used for ordering and is checked against the generated moves, so that costs nothing but order
+    static uint64_t hash(const Position &pos) { return pos.hash(); }
+    static int      orderScore(const Position &pos, const Move &move) { return pos.orderScore(move); }
+    static int      moveIndex(const Move &move) { return move; }
+};
@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const char *path)
+{
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    _file = file;
+    _mapping = mapping;
+    _data = (const uint8_t *)view;
+    _size = (size_t)size.QuadPart;
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    void *view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+    _data = (const uint8_t *)view;
+    _size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(_data);
+        CloseHandle((HANDLE)_mapping);
+        CloseHandle((HANDLE)_file);
+        _mapping = nullptr;
+        _file = nullptr;
+#else
+        munmap((void *)_data, _size);
+#endif
+    }
+    _data = nullptr;
+    _size = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// a whole file mapped read only into memory. pages are read in by the OS as they're touched, so opening
+// a large file costs nothing up front
+//
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // false when the file is missing or empty
+    bool open(const char *path);
+    void close();
+    bool isOpen() const { return _data != nullptr; }
+
+    const uint8_t *data() const { return _data; }
+    size_t         size() const { return _size; }
+
+private:
+    const uint8_t  *_data = nullptr;
+    size_t          _size = 0;
+#if defined(_WIN32)
+    void           *_file = nullptr;
+    void           *_mapping = nullptr;
+#endif
+};
@@ -0,0 +1,101 @@
+#include "MoveLog.h"
+#include <cstdlib>
+
+void MoveLog::reset(const std::string &state)
+{
+    _changes.clear();
+    _turnEnds.clear();
+    _snapshots.assign(1, state);
+    _state = state;
+    _current = 0;
+}
+
+void MoveLog::record(const std::string &state)
+{
+    // a new turn after an undo starts a new line, the turns that were undone are gone
+    if (_current < turns())
+    {
+        _changes.resize(_current == 0 ? 0 : _turnEnds[_current - 1]);
+        _turnEnds.resize(_current);
+        _snapshots.resize(_current / kSnapshotInterval + 1);
+    }
+
+    // games keep the same layout all game, but start over if the size ever changes
+    if (state.size() != _state.size())
+    {
+        reset(state);
+        return;
+    }
+    for (size_t cell = 0; cell < state.size(); cell++)
+    {
+        if (state[cell] != _state[cell])
+        {
+            _changes.push_back({ (uint16_t)cell, _state[cell], state[cell] });
+        }
+    }
+    _turnEnds.push_back((uint32_t)_changes.size());
+    _state = state;
+    _current++;
+    if (_current % kSnapshotInterval == 0)
+    {
+        _snapshots.push_back(state);
+    }
+}
+
+const std::string &MoveLog::undo()
+{
+    if (canUndo())
+    {
+        for (int i = (int)_turnEnds[_current - 1] - 1; i >= turnBegin(_current); i--)
+        {
+            _state[_changes[i].cell] = _changes[i].before;
+        }
+        _current--;
+    }
+    return _state;
+}
+
+const std::string &MoveLog::redo()
+{
+    if (canRedo())
+    {
+        _current++;
+        for (int i = turnBegin(_current); i < (int)_turnEnds[_current - 1]; i++)
+        {
+            _state[_changes[i].cell] = _changes[i].after;
+        }
+    }
+    return _state;
+}
+
+const std::string &MoveLog::seek(int turn)
+{
+    turn = turn < 0 ? 0 : (turn > turns() ? turns() : turn);
+
+    // start from whichever is closer, the current turn or the snapshot at or before the target
+    int snapshot = turn / kSnapshotInterval;
+    if (turn - snapshot * kSnapshotInterval < std::abs(turn - _current))
+    {
+        _state = _snapshots[snapshot];
+        _current = snapshot * kSnapshotInterval;
+    }
+    while (_current > turn)
+    {
+        undo();
+    }
+    while (_current < turn)
+    {
+        redo();
+    }
+    return _state;
+}
+
+size_t MoveLog::memoryUsed() const
+{
+    size_t bytes = _changes.capacity() * sizeof(Change) + _turnEnds.capacity() * sizeof(uint32_t);
+    for (const std::string &snapshot : _snapshots)
+    {
+        bytes += snapshot.capacity();
+    }
+    return bytes;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// turn history as a log of what changed on the board each turn
+// a turn is stored as the state string cells it changed, before and after, so stepping back or forward one
+// turn costs only what that turn touched. the whole state is kept every kSnapshotInterval turns, so reaching
+// any turn takes fewer than kSnapshotInterval steps from a snapshot or from the current turn.
+//
+class MoveLog
+{
+public:
+    static constexpr int kSnapshotInterval = 32;
+
+    // starts a new history at turn 0 with the given state
+    void reset(const std::string &state);
+    // adds the turn that leads to state after the current one, dropping any turns that were undone
+    void record(const std::string &state);
+
+    int  turns() const { return (int)_turnEnds.size(); }
+    int  current() const { return _current; }
+    bool canUndo() const { return _current > 0; }
+    bool canRedo() const { return _current < turns(); }
+
+    // the state at the current turn
+    const std::string &state() const { return _state; }
+
+    // each one moves the current turn and returns the state there
+    const std::string &undo();
+    const std::string &redo();
+    const std::string &seek(int turn);
+
+    // bytes held by the log, the changes plus the snapshots
+    size_t memoryUsed() const;
+
+private:
+    struct Change
+    {
+        uint16_t cell;
+        char     before;
+        char     after;
+    };
+
+    int  turnBegin(int turn) const { return turn == 1 ? 0 : (int)_turnEnds[turn - 2]; }
+
+    // the changes of turn t (t >= 1) are _changes[turnBegin(t)] up to _changes[_turnEnds[t - 1]]
+    std::vector<Change>      _changes;
+    std::vector<uint32_t>    _turnEnds;
+    // the state at turns 0, kSnapshotInterval, 2 * kSnapshotInterval, ...
+    std::vector<std::string> _snapshots;
+
+    std::string _state;
+    int         _current = 0;
+};
@@ -1,14 +1,11 @@
 #include "Othello.h"
+#include "Bitboard.h"
 #include <iostream>
 
-// Define the 8 directions: N, NE, E, SE, S, SW, W, NW
-const int Othello::DIRECTIONS[8][2] = {
-    {0, -1}, {1, -1}, {1, 0}, {1, 1},
-    {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
-};
-
-Othello::Othello() : Game() {
+Othello::Othello() : Game(), _search(1 << 16), _endgame(1 << 18) {
     _grid = new Grid(8, 8);
+    _discs[BLACK_PLAYER] = 0;
+    _discs[WHITE_PLAYER] = 0;
     _consecutivePasses = 0;
     _showingHints = false;
 }
@@ -24,34 +21,46 @@ void Othello::setUpBoard() {
 
     _grid->initializeSquares(80, "boardsquare.png");
 
-    // Set up initial four pieces in the center
-    Player* blackPlayer = getPlayerAt(BLACK_PLAYER);
-    Player* whitePlayer = getPlayerAt(WHITE_PLAYER);
-
-    // Standard Othello starting position
-    auto placePiece = [&](int x, int y, Player* player) {
-        Bit* piece = createPiece(player);
-        piece->setPosition(_grid->getSquare(x, y)->getPosition());
-        _grid->getSquare(x, y)->setBit(piece);
-    };
-
-    placePiece(3, 3, whitePlayer);  // White at (3,3)
-    placePiece(4, 4, whitePlayer);  // White at (4,4)
-    placePiece(4, 3, blackPlayer);  // Black at (4,3)
-    placePiece(3, 4, blackPlayer);  // Black at (3,4)
+    // Standard Othello starting position, black moves first
+    OthelloBoard start = OthelloBoard::initial();
+    _discs[BLACK_PLAYER] = start.player;
+    _discs[WHITE_PLAYER] = start.opponent;
+    for (int player = BLACK_PLAYER; player <= WHITE_PLAYER; player++) {
+        for (uint64_t bits = _discs[player]; bits; bits &= bits - 1) {
+            placePiece(bitScanForward64(bits), getPlayerAt(player));
+        }
+    }
 
     if (gameHasAI()) {
         setAIPlayer(AI_PLAYER);
     }
-    
+
     startGame();
 }
 
 Bit* Othello::createPiece(Player* player) {
-    Bit* bit = new Bit();
+    Bit* bit = _bitPool.acquire();
+    paintPiece(bit, player);
+    return bit;
+}
+
+// gives a disc to the player, the texture comes out of the shared cache so this is cheap enough to do per flip
+void Othello::paintPiece(Bit* bit, Player* player) {
     bit->LoadTextureFromFile(player == getPlayerAt(BLACK_PLAYER) ? "o.png" : "x.png");
     bit->setOwner(player);
-    return bit;
+}
+
+// puts a sprite for the player's disc on the square, the bitboards are updated by the caller
+void Othello::placePiece(int square, Player* player) {
+    ChessSquare* holder = _grid->getSquare(square % 8, square / 8);
+    Bit* piece = createPiece(player);
+    piece->setPosition(holder->getPosition());
+    holder->setBit(piece);
+}
+
+uint64_t Othello::legalMovesFor(Player* player) const {
+    int me = player->playerNumber();
+    return OthelloBoard::legalMoves(_discs[me], _discs[1 - me]);
 }
 
 bool Othello::actionForEmptyHolder(BitHolder &holder) {
@@ -64,28 +73,27 @@ bool Othello::actionForEmptyHolder(BitHolder &holder) {
 
     if (!isValidMove(x, y, currentPlayer)) return false;
 
-    // Place the piece
-    Bit* newPiece = createPiece(currentPlayer);
-    newPiece->setPosition(holder.getPosition());
-    holder.setBit(newPiece);
+    // Play the move on the bitboards
+    int index = y * 8 + x;
+    int me = currentPlayer->playerNumber();
+    uint64_t flipped = OthelloBoard::flips(_discs[me], _discs[1 - me], index);
+    _discs[me] |= flipped | (1ull << index);
+    _discs[1 - me] &= ~flipped;
 
-    // Flip all affected pieces
-    flipPieces(x, y, currentPlayer);
+    // Then bring the sprites in line
+    placePiece(index, currentPlayer);
+    flipPieces(flipped, currentPlayer);
     _consecutivePasses = 0;
+    endTurn();
 
-    // Check if next player has moves
-    Player* nextPlayer = getPlayerAt(1 - currentPlayer->playerNumber());
-    if (!hasValidMove(nextPlayer)) {
+    // The next player has nothing to play but the current one does, so they pass and the current player continues.
+    // The pass is a turn of its own, so undo takes back one move at a time and the turn number keeps matching the
+    // player to move
+    Player* nextPlayer = getPlayerAt(1 - me);
+    if (!hasValidMove(nextPlayer) && hasValidMove(currentPlayer)) {
         _consecutivePasses++;
-        if (hasValidMove(currentPlayer)) {
-            // Next player passes, current player continues
-            return true;
-        } else {
-            _consecutivePasses = 2; // Game ends
-        }
+        endTurn();
     }
-
-    endTurn();
     return true;
 }
 
@@ -98,88 +106,37 @@ bool Othello::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
 }
 
 bool Othello::isValidMove(int x, int y, Player* player) const {
-    if (!_grid->isValid(x, y) || _grid->getSquare(x, y)->bit()) return false;
-
-    // Check if placing a piece here would flip at least one opponent piece
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player) > 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
-int Othello::checkDirection(int x, int y, int dx, int dy, Player* player) const {
-    int count = 0;
-    int nx = x + dx;
-    int ny = y + dy;
-
-    if (!_grid->isValid(nx, ny)) return 0;
-
-    Bit* firstPiece = _grid->getSquare(nx, ny)->bit();
-    if (!firstPiece || firstPiece->getOwner() == player) return 0;
-
-    // Count opponent pieces in this direction
-    while (_grid->isValid(nx, ny)) {
-        Bit* piece = _grid->getSquare(nx, ny)->bit();
-        if (!piece) return 0;
-        if (piece->getOwner() == player) return count;
-        count++;
-        nx += dx;
-        ny += dy;
-    }
-    return 0;
+    if (!_grid->isValid(x, y)) return false;
+    return (legalMovesFor(player) >> (y * 8 + x)) & 1;
 }
 
-void Othello::flipPieces(int x, int y, Player* player) {
-    for (int i = 0; i < 8; i++) {
-        int count = checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player);
-        if (count > 0) {
-            flipInDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player, count);
+void Othello::flipPieces(uint64_t flipped, Player* player) {
+    for (; flipped; flipped &= flipped - 1) {
+        int index = bitScanForward64(flipped);
+        Bit* bit = _grid->getSquare(index % 8, index / 8)->bit();
+        if (bit) {
+            paintPiece(bit, player);
         }
     }
 }
 
-void Othello::flipInDirection(int x, int y, int dx, int dy, Player* player, int count) {
-    int nx = x + dx;
-    int ny = y + dy;
-
-    for (int i = 0; i < count; i++) {
-        ChessSquare* square = _grid->getSquare(nx, ny);
-        if (square && square->bit()) {
-            square->destroyBit();
-            Bit* newPiece = createPiece(player);
-            newPiece->setPosition(square->getPosition());
-            square->setBit(newPiece);
-        }
-        nx += dx;
-        ny += dy;
-    }
-}
-
 bool Othello::hasValidMove(Player* player) const {
-    bool hasMove = false;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (!hasMove && isValidMove(x, y, player)) {
-            hasMove = true;
-        }
-    });
-    return hasMove;
+    return legalMovesFor(player) != 0;
 }
 
 std::vector<std::pair<int, int>> Othello::getValidMoves(Player* player) const {
     std::vector<std::pair<int, int>> moves;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (isValidMove(x, y, player)) {
-            moves.push_back({x, y});
-        }
-    });
+    for (uint64_t bits = legalMovesFor(player); bits; bits &= bits - 1) {
+        int index = bitScanForward64(bits);
+        moves.push_back({index % 8, index / 8});
+    }
     return moves;
 }
 
 Player* Othello::checkForWinner() {
-    // Game ends when neither player can move
-    if (_consecutivePasses >= 2 ||
+    // Game ends when neither player can move or the board is full
+    bool boardFull = (_discs[BLACK_PLAYER] | _discs[WHITE_PLAYER]) == ~0ull;
+    if (boardFull || _consecutivePasses >= 2 ||
         (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
 
         int blackCount, whiteCount;
@@ -189,63 +146,31 @@ Player* Othello::checkForWinner() {
         if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
     }
 
-    // Check if board is full
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
-        if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
-    }
-
     return nullptr;
 }
 
 bool Othello::checkForDraw() {
-    if (_consecutivePasses >= 2 ||
+    bool boardFull = (_discs[BLACK_PLAYER] | _discs[WHITE_PLAYER]) == ~0ull;
+    if (boardFull || _consecutivePasses >= 2 ||
         (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
         int blackCount, whiteCount;
         countPieces(blackCount, whiteCount);
         return blackCount == whiteCount;
     }
-
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
-    }
     return false;
 }
 
 void Othello::countPieces(int &blackCount, int &whiteCount) const {
-    blackCount = 0;
-    whiteCount = 0;
-
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit* piece = square->bit();
-        if (piece) {
-            if (piece->getOwner() == getPlayerAt(BLACK_PLAYER)) {
-                blackCount++;
-            } else {
-                whiteCount++;
-            }
-        }
-    });
+    blackCount = popCount64(_discs[BLACK_PLAYER]);
+    whiteCount = popCount64(_discs[WHITE_PLAYER]);
 }
 
 void Othello::stopGame() {
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
+    _discs[BLACK_PLAYER] = 0;
+    _discs[WHITE_PLAYER] = 0;
     _consecutivePasses = 0;
 }
 
@@ -259,38 +184,33 @@ std::string Othello::initialStateString() {
 }
 
 std::string Othello::stateString() {
-    std::string state;
-    _grid->forEachSquare([&state, this](ChessSquare* square, int x, int y) {
-        Bit* bit = square->bit();
-        if (!bit) {
-            state += '0';
-        } else if (bit->getOwner() == getPlayerAt(BLACK_PLAYER)) {
-            state += '1';
-        } else {
-            state += '2';
-        }
-    });
+    std::string state(64, '0');
+    for (uint64_t bits = _discs[BLACK_PLAYER]; bits; bits &= bits - 1) {
+        state[bitScanForward64(bits)] = '1';
+    }
+    for (uint64_t bits = _discs[WHITE_PLAYER]; bits; bits &= bits - 1) {
+        state[bitScanForward64(bits)] = '2';
+    }
     return state;
 }
 
 void Othello::setStateString(const std::string &s) {
     if (s.length() != 64) return;
 
-    int index = 0;
+    boardChanged();
+    _discs[BLACK_PLAYER] = 0;
+    _discs[WHITE_PLAYER] = 0;
+    // passes are worked out again from the position on the next move
+    _consecutivePasses = 0;
     _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (index < s.length()) {
-            char pieceType = s[index++];
-            square->destroyBit();
-
-            if (pieceType == '1') {
-                Bit* piece = createPiece(getPlayerAt(BLACK_PLAYER));
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            } else if (pieceType == '2') {
-                Bit* piece = createPiece(getPlayerAt(WHITE_PLAYER));
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            }
+        int index = y * 8 + x;
+        char pieceType = s[index];
+        square->destroyBit();
+
+        if (pieceType == '1' || pieceType == '2') {
+            int player = (pieceType == '1') ? BLACK_PLAYER : WHITE_PLAYER;
+            _discs[player] |= 1ull << index;
+            placePiece(index, getPlayerAt(player));
         }
     });
 }
@@ -298,33 +218,38 @@ void Othello::setStateString(const std::string &s) {
 void Othello::updateAI() {
     if (!gameHasAI()) return;
 
-    Player* aiPlayer = getCurrentPlayer();
-    std::vector<std::pair<int, int>> validMoves = getValidMoves(aiPlayer);
+    // how long the AI may think about a move
+    const int64_t thinkTimeMs = 1000;
+
+    int me = getCurrentPlayer()->playerNumber();
+    OthelloPosition position;
+    position.board.player = _discs[me];
+    position.board.opponent = _discs[1 - me];
+    position.passes = 0;
 
-    if (validMoves.empty()) {
+    if (!position.board.legalMoves()) {
         _consecutivePasses++;
         endTurn();
         return;
     }
 
-    // Find move that flips the most pieces
-    int bestX = -1, bestY = -1, maxFlips = 0;
-
-    for (const auto& move : validMoves) {
-        int x = move.first, y = move.second, totalFlips = 0;
-        for (int i = 0; i < 8; i++) {
-            totalFlips += checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], aiPlayer);
-        }
-        if (totalFlips > maxFlips) {
-            maxFlips = totalFlips;
-            bestX = x;
-            bestY = y;
+    int move = OthelloSearchTraits::kPass;
+    if (popCount64(position.board.empties()) <= OthelloEndgame::kMaxEmpties) {
+        OthelloEndgameResult solved = _endgame.solve(position.board, thinkTimeMs);
+        if (solved.completed) {
+            move = solved.move;
         }
     }
 
-    if (bestX >= 0 && bestY >= 0) {
-        actionForEmptyHolder(*_grid->getSquare(bestX, bestY));
+    if (move == OthelloSearchTraits::kPass) {
+        // midgame, or the solver ran out of time: a shorter heuristic search picks the move instead
+        SearchLimits limits;
+        limits.timeMs = popCount64(position.board.empties()) <= OthelloEndgame::kMaxEmpties ? thinkTimeMs / 4 : thinkTimeMs;
+        auto result = _search.run(position, limits);
+        move = result.bestMove;
     }
+
+    actionForEmptyHolder(*_grid->getSquare(move % 8, move / 8));
 }
 
 void Othello::getBoardPosition(BitHolder& holder, int &x, int &y) const {
@@ -339,4 +264,4 @@ void Othello::showValidMoves(Player* player) {
 
 void Othello::clearValidMoveIndicators() {
     _showingHints = false;
-}
\ No newline at end of file
+}
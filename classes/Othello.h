@@ -1,5 +1,7 @@
 #pragma once
 #include "Game.h"
+#include "OthelloBoard.h"
+#include "OthelloEndgame.h"
 #include <vector>
 
 // NOTE: This implementation assumes black.png and white.png exist in resources.
@@ -28,33 +30,37 @@ public:
     bool        gameHasAI() override { return true; } // Set to true when AI is implemented
     Grid* getGrid() override { return _grid; }
 
+    std::vector<std::pair<int, int>> getValidMoves(Player* player) const;
+
 private:
     // Player constants
     static const int BLACK_PLAYER = 0;
     static const int WHITE_PLAYER = 1;
 
-    // Direction vectors for checking all 8 directions
-    static const int DIRECTIONS[8][2];
-
     // Helper methods
     Bit*        createPiece(Player* player);
+    void        paintPiece(Bit* bit, Player* player);
+    void        placePiece(int square, Player* player);
+    uint64_t    legalMovesFor(Player* player) const;
     bool        isValidMove(int x, int y, Player* player) const;
-    int         checkDirection(int x, int y, int dx, int dy, Player* player) const;
-    void        flipPieces(int x, int y, Player* player);
-    void        flipInDirection(int x, int y, int dx, int dy, Player* player, int count);
+    void        flipPieces(uint64_t flipped, Player* player);
     bool        hasValidMove(Player* player) const;
     void        countPieces(int &blackCount, int &whiteCount) const;
-    std::vector<std::pair<int, int>> getValidMoves(Player* player) const;
     void        showValidMoves(Player* player);
     void        clearValidMoveIndicators();
 
     // Board position helper
     void        getBoardPosition(BitHolder& holder, int &x, int &y) const;
 
-    // Board representation
+    // Board representation, the bitboards are the rules and the grid only shows them
     Grid*       _grid;
+    uint64_t    _discs[2];
 
     // Game state
     int         _consecutivePasses;
     bool        _showingHints;
+
+    // alpha-beta for the midgame, the exact solver once OthelloEndgame::kMaxEmpties or fewer squares are left
+    Search<OthelloSearchTraits> _search;
+    OthelloEndgame              _endgame;
 };
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include "OthelloBoard.h"
+#include "Bitboard.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OTHELLO_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <stdlib.h>
+#define OTHELLO_BSWAP64(x) _byteswap_uint64(x)
+#else
+#define OTHELLO_BSWAP64(x) __builtin_bswap64(x)
+#endif
+
+// opponent discs that a horizontal or diagonal run may pass through, the a and h files would wrap
+static const uint64_t kInner = 0x7E7E7E7E7E7E7E7Eull;
+
+template <int S>
+static inline uint64_t shift(uint64_t bits)
+{
+    return S > 0 ? bits << S : bits >> -S;
+}
+
+OthelloBoard OthelloBoard::initial()
+{
+    OthelloBoard board;
+    board.player = (1ull << 28) | (1ull << 35);
+    board.opponent = (1ull << 27) | (1ull << 36);
+    return board;
+}
+
+//
+// dumb7fill: grow runs of opponent discs out from our discs one step at a time,
+// the empty square just past a run is a legal move. six steps cover the longest possible run.
+//
+template <int S>
+static inline uint64_t movesInDirection(uint64_t player, uint64_t mask)
+{
+    uint64_t run = mask & shift<S>(player);
+    run |= mask & shift<S>(run);
+    run |= mask & shift<S>(run);
+    run |= mask & shift<S>(run);
+    run |= mask & shift<S>(run);
+    run |= mask & shift<S>(run);
+    return shift<S>(run);
+}
+
+uint64_t OthelloBoard::legalMoves(uint64_t player, uint64_t opponent)
+{
+    uint64_t inner = opponent & kInner;
+    uint64_t moves = movesInDirection<1>(player, inner) | movesInDirection<-1>(player, inner) |
+                     movesInDirection<8>(player, opponent) | movesInDirection<-8>(player, opponent) |
+                     movesInDirection<7>(player, inner) | movesInDirection<-7>(player, inner) |
+                     movesInDirection<9>(player, inner) | movesInDirection<-9>(player, inner);
+    return moves & ~(player | opponent);
+}
+
+// the run of opponent discs next to the move, kept only if one of our discs closes it
+template <int S>
+static inline uint64_t flipsInDirection(uint64_t move, uint64_t player, uint64_t mask)
+{
+    uint64_t run = shift<S>(move) & mask;
+    run |= shift<S>(run) & mask;
+    run |= shift<S>(run) & mask;
+    run |= shift<S>(run) & mask;
+    run |= shift<S>(run) & mask;
+    run |= shift<S>(run) & mask;
+    return (shift<S>(run) & player) ? run : 0;
+}
+
+#if defined(__AVX2__)
+
+//
+// AVX2: one lane per direction, the four directions towards higher squares and then the four towards lower squares
+//
+uint64_t OthelloBoard::flips(uint64_t player, uint64_t opponent, int square)
+{
+    const __m256i shifts = _mm256_set_epi64x(9, 8, 7, 1);
+    const __m256i masks = _mm256_set_epi64x((long long)kInner, -1LL, (long long)kInner, (long long)kInner);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i pp = _mm256_set1_epi64x((long long)player);
+    __m256i oo = _mm256_and_si256(_mm256_set1_epi64x((long long)opponent), masks);
+    __m256i mv = _mm256_set1_epi64x((long long)(1ull << square));
+
+    __m256i up = _mm256_and_si256(_mm256_sllv_epi64(mv, shifts), oo);
+    __m256i down = _mm256_and_si256(_mm256_srlv_epi64(mv, shifts), oo);
+    for (int i = 0; i < 5; i++)
+    {
+        up = _mm256_or_si256(up, _mm256_and_si256(_mm256_sllv_epi64(up, shifts), oo));
+        down = _mm256_or_si256(down, _mm256_and_si256(_mm256_srlv_epi64(down, shifts), oo));
+    }
+    __m256i upClosed = _mm256_and_si256(_mm256_sllv_epi64(up, shifts), pp);
+    __m256i downClosed = _mm256_and_si256(_mm256_srlv_epi64(down, shifts), pp);
+    __m256i flipped = _mm256_or_si256(_mm256_andnot_si256(_mm256_cmpeq_epi64(upClosed, zero), up),
+                                      _mm256_andnot_si256(_mm256_cmpeq_epi64(downClosed, zero), down));
+
+    __m128i lanes = _mm_or_si128(_mm256_castsi256_si128(flipped), _mm256_extracti128_si256(flipped, 1));
+    lanes = _mm_or_si128(lanes, _mm_unpackhi_epi64(lanes, lanes));
+    return (uint64_t)_mm_cvtsi128_si64(lanes);
+}
+
+#elif defined(OTHELLO_SSE2)
+
+//
+// SSE2 has no per-lane shift counts, so the second lane holds the board mirrored top to bottom (a byte swap).
+// shifting that lane towards higher squares walks the original board towards lower ones, which covers
+// the vertical and diagonal directions two at a time. the horizontal pair stays scalar.
+//
+template <int S>
+static inline __m128i flipsInDirectionPair(__m128i move, __m128i player, __m128i mask)
+{
+    __m128i run = _mm_and_si128(_mm_slli_epi64(move, S), mask);
+    run = _mm_or_si128(run, _mm_and_si128(_mm_slli_epi64(run, S), mask));
+    run = _mm_or_si128(run, _mm_and_si128(_mm_slli_epi64(run, S), mask));
+    run = _mm_or_si128(run, _mm_and_si128(_mm_slli_epi64(run, S), mask));
+    run = _mm_or_si128(run, _mm_and_si128(_mm_slli_epi64(run, S), mask));
+    run = _mm_or_si128(run, _mm_and_si128(_mm_slli_epi64(run, S), mask));
+    __m128i closed = _mm_and_si128(_mm_slli_epi64(run, S), player);
+    // SSE2 has no 64-bit compare, test the two lanes as scalars
+    long long low = _mm_cvtsi128_si64(closed);
+    long long high = _mm_cvtsi128_si64(_mm_unpackhi_epi64(closed, closed));
+    return _mm_and_si128(run, _mm_set_epi64x(high ? -1LL : 0, low ? -1LL : 0));
+}
+
+uint64_t OthelloBoard::flips(uint64_t player, uint64_t opponent, int square)
+{
+    uint64_t move = 1ull << square;
+    __m128i mv = _mm_set_epi64x((long long)OTHELLO_BSWAP64(move), (long long)move);
+    __m128i pp = _mm_set_epi64x((long long)OTHELLO_BSWAP64(player), (long long)player);
+    __m128i oo = _mm_set_epi64x((long long)OTHELLO_BSWAP64(opponent), (long long)opponent);
+    __m128i inner = _mm_and_si128(oo, _mm_set1_epi64x((long long)kInner));
+
+    __m128i flipped = _mm_or_si128(flipsInDirectionPair<8>(mv, pp, oo),
+                                   _mm_or_si128(flipsInDirectionPair<7>(mv, pp, inner), flipsInDirectionPair<9>(mv, pp, inner)));
+    uint64_t result = (uint64_t)_mm_cvtsi128_si64(flipped) |
+                      OTHELLO_BSWAP64((uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(flipped, flipped)));
+
+    uint64_t innerOpponent = opponent & kInner;
+    return result | flipsInDirection<1>(move, player, innerOpponent) | flipsInDirection<-1>(move, player, innerOpponent);
+}
+
+#else
+
+uint64_t OthelloBoard::flips(uint64_t player, uint64_t opponent, int square)
+{
+    uint64_t move = 1ull << square;
+    uint64_t inner = opponent & kInner;
+    return flipsInDirection<1>(move, player, inner) | flipsInDirection<-1>(move, player, inner) |
+           flipsInDirection<8>(move, player, opponent) | flipsInDirection<-8>(move, player, opponent) |
+           flipsInDirection<7>(move, player, inner) | flipsInDirection<-7>(move, player, inner) |
+           flipsInDirection<9>(move, player, inner) | flipsInDirection<-9>(move, player, inner);
+}
+
+#endif
+
+// ==============================================================
+// stability
+// ==============================================================
+
+static const uint64_t kFileA = 0x0101010101010101ull;
+static const uint64_t kFileH = 0x8080808080808080ull;
+static const uint64_t kRank1 = 0x00000000000000FFull;
+static const uint64_t kRank8 = 0xFF00000000000000ull;
+
+// filled squares from which the line in direction S stays filled up to the edge,
+// edge holds the squares whose neighbor in direction S is off the board
+template <int S>
+static inline uint64_t filledToEdge(uint64_t filled, uint64_t edge)
+{
+    uint64_t run = filled & edge;
+    for (int i = 0; i < 7; i++)
+    {
+        run = filled & (edge | shift<-S>(run));
+    }
+    return run;
+}
+
+// squares that are safe along the axis through S whatever happens next: on an edge or on a full line
+template <int S>
+static inline uint64_t fixedOnAxis(uint64_t filled, uint64_t edgeUp, uint64_t edgeDown)
+{
+    return edgeUp | edgeDown | (filledToEdge<S>(filled, edgeUp) & filledToEdge<-S>(filled, edgeDown));
+}
+
+uint64_t OthelloBoard::stableDiscs(uint64_t discs, uint64_t filled)
+{
+    const uint64_t horizontal = fixedOnAxis<1>(filled, kFileH, kFileA);
+    const uint64_t vertical = fixedOnAxis<8>(filled, kRank8, kRank1);
+    const uint64_t diagonal = fixedOnAxis<9>(filled, kFileH | kRank8, kFileA | kRank1);
+    const uint64_t antiDiagonal = fixedOnAxis<7>(filled, kFileA | kRank8, kFileH | kRank1);
+
+    // a stable neighbor shifted across a board edge only lands on squares that are already fixed on that axis
+    uint64_t stable = 0;
+    for (;;)
+    {
+        uint64_t next = discs &
+                        (horizontal | shift<1>(stable) | shift<-1>(stable)) &
+                        (vertical | shift<8>(stable) | shift<-8>(stable)) &
+                        (diagonal | shift<9>(stable) | shift<-9>(stable)) &
+                        (antiDiagonal | shift<7>(stable) | shift<-7>(stable));
+        if (next == stable)
+        {
+            return stable;
+        }
+        stable = next;
+    }
+}
+
+// ==============================================================
+// search traits
+// ==============================================================
+
+static const uint64_t kCorners = 0x8100000000000081ull;
+
+// the squares next to each corner, they hand the corner over while it is still empty
+static const uint64_t kCornerNeighbors[4] = {
+    0x0000000000000302ull, 0x000000000000C040ull, 0x0203000000000000ull, 0x40C0000000000000ull
+};
+static const uint64_t kCornerSquares[4] = { 1ull << 0, 1ull << 7, 1ull << 56, 1ull << 63 };
+
+int OthelloSearchTraits::generateMoves(const Position &pos, Move *moves)
+{
+    int count = 0;
+    for (uint64_t bits = pos.board.legalMoves(); bits; bits &= bits - 1)
+    {
+        moves[count++] = bitScanForward64(bits);
+    }
+    if (count == 0)
+    {
+        moves[count++] = kPass;
+    }
+    return count;
+}
+
+void OthelloSearchTraits::makeMove(Position &pos, const Move &move, Undo &undo)
+{
+    undo.passes = pos.passes;
+    if (move == kPass)
+    {
+        undo.flipped = 0;
+        pos.board.pass();
+        pos.passes++;
+        return;
+    }
+    undo.flipped = pos.board.play(move);
+    pos.passes = 0;
+}
+
+void OthelloSearchTraits::unmakeMove(Position &pos, const Move &move, const Undo &undo)
+{
+    pos.board.pass();
+    if (move != kPass)
+    {
+        pos.board.player &= ~(undo.flipped | (1ull << move));
+        pos.board.opponent |= undo.flipped;
+    }
+    pos.passes = undo.passes;
+}
+
+//
+// midgame evaluation from the side to move: corners, discs that can no longer be flipped,
+// and mobility. raw disc count is left out, it only starts to matter once the endgame solver takes over.
+//
+int OthelloSearchTraits::evaluate(const Position &pos)
+{
+    uint64_t player = pos.board.player;
+    uint64_t opponent = pos.board.opponent;
+    uint64_t filled = player | opponent;
+
+    int corners = popCount64(player & kCorners) - popCount64(opponent & kCorners);
+
+    int cornerGifts = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (!(filled & kCornerSquares[i]))
+        {
+            cornerGifts += popCount64(player & kCornerNeighbors[i]) - popCount64(opponent & kCornerNeighbors[i]);
+        }
+    }
+
+    int stability = popCount64(OthelloBoard::stableDiscs(player, filled)) -
+                    popCount64(OthelloBoard::stableDiscs(opponent, filled));
+
+    int playerMoves = popCount64(OthelloBoard::legalMoves(player, opponent));
+    int opponentMoves = popCount64(OthelloBoard::legalMoves(opponent, player));
+    // relative mobility, having 2 moves against 1 matters more than 12 against 11
+    int mobility = (100 * (playerMoves - opponentMoves)) / (playerMoves + opponentMoves + 2);
+
+    return 80 * corners - 25 * cornerGifts + 12 * stability + 2 * mobility;
+}
+
+bool OthelloSearchTraits::isTerminal(const Position &pos, int &score)
+{
+    if (pos.board.empties() && pos.passes < 2)
+    {
+        return false;
+    }
+    int mine = popCount64(pos.board.player);
+    int theirs = popCount64(pos.board.opponent);
+    score = mine > theirs ? SearchScore::kWin : (mine < theirs ? -SearchScore::kWin : 0);
+    return true;
+}
+
+int OthelloSearchTraits::orderScore(const Position &pos, const Move &move)
+{
+    // corners can never be flipped back, try them first
+    return (move != kPass && ((1ull << move) & kCorners)) ? 1 : 0;
+}
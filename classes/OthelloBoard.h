@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Search.h"
+#include <cstdint>
+
+//
+// bitboard othello core
+// square index is y * 8 + x, the same order as the state string. the board is kept as
+// two bitboards relative to the side to move, so move generation never needs to know colors.
+// legal moves come from shift-and-mask fills in all 8 directions and the discs flipped by a move
+// are computed as a bitboard, with SSE2/AVX2 versions when the compiler targets them.
+//
+struct OthelloBoard
+{
+    // discs of the side to move and of the other side
+    uint64_t player = 0;
+    uint64_t opponent = 0;
+
+    // black to move on (4,3) and (3,4), white on (3,3) and (4,4), matching Othello::setUpBoard
+    static OthelloBoard initial();
+
+    static uint64_t legalMoves(uint64_t player, uint64_t opponent);
+    static uint64_t flips(uint64_t player, uint64_t opponent, int square);
+    // discs that can never be flipped again: along every line they touch the edge, a stable disc
+    // of their own color, or the line is full. a conservative approximation, grown out from the corners.
+    static uint64_t stableDiscs(uint64_t discs, uint64_t filled);
+
+    uint64_t legalMoves() const { return legalMoves(player, opponent); }
+    uint64_t empties() const { return ~(player | opponent); }
+    uint64_t hash() const { return zobristKey(player ^ zobristKey(opponent)); }
+
+    // plays a legal move for the side to move and hands the turn over, returns the flipped discs
+    uint64_t play(int square)
+    {
+        uint64_t flipped = flips(player, opponent, square);
+        player |= flipped | (1ull << square);
+        opponent &= ~flipped;
+        pass();
+        return flipped;
+    }
+    void pass()
+    {
+        uint64_t swap = player;
+        player = opponent;
+        opponent = swap;
+    }
+};
+
+//
+// search plumbing: the board plus how many passes in a row led here (two ends the game)
+//
+struct OthelloPosition
+{
+    OthelloBoard board;
+    uint8_t passes;
+};
+
+struct OthelloSearchTraits
+{
+    using Position = OthelloPosition;
+    // a square index, or kPass when the side to move has nothing to play
+    using Move = int;
+    struct Undo { uint64_t flipped; uint8_t passes; };
+
+    static constexpr int kPass = 64;
+    static constexpr int kMaxMoves = 64;
+    static constexpr int kMoveIndexSize = 65;
+
+    static int      generateMoves(const Position &pos, Move *moves);
+    static void     makeMove(Position &pos, const Move &move, Undo &undo);
+    static void     unmakeMove(Position &pos, const Move &move, const Undo &undo);
+    static int      evaluate(const Position &pos);
+    static bool     isTerminal(const Position &pos, int &score);
+    static int      noMovesScore(const Position &pos) { return 0; }
+    static uint64_t hash(const Position &pos) { return pos.board.hash(); }
+    static int      orderScore(const Position &pos, const Move &move);
+    static int      moveIndex(const Move &move) { return move; }
+};
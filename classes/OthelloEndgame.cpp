@@ -0,0 +1,317 @@
+#include "OthelloEndgame.h"
+#include "Bitboard.h"
+
+// below this many empties the solver skips the table and mobility ordering
+static const int kParityOnlyEmpties = 6;
+// scores run from -64 to 64, a window one wider on each side holds every exact result
+static const int kScoreBound = 65;
+
+static const uint64_t kQuadrants[4] = {
+    0x000000000F0F0F0Full, 0x00000000F0F0F0F0ull, 0x0F0F0F0F00000000ull, 0xF0F0F0F000000000ull
+};
+
+// the quadrants holding an odd number of empty squares
+static inline uint64_t oddQuadrants(uint64_t empty)
+{
+    uint64_t odd = 0;
+    for (uint64_t quadrant : kQuadrants)
+    {
+        if (popCount64(empty & quadrant) & 1)
+        {
+            odd |= quadrant;
+        }
+    }
+    return odd;
+}
+
+// game over, the empty squares are counted for the winner
+static inline int finalScore(uint64_t player, uint64_t opponent)
+{
+    int diff = popCount64(player) - popCount64(opponent);
+    int empties = 64 - popCount64(player | opponent);
+    return diff > 0 ? diff + empties : (diff < 0 ? diff - empties : 0);
+}
+
+//
+// a legal move with the position it leads to, already turned around for the opponent
+//
+struct EndgameCandidate
+{
+    int square;
+    uint64_t player;
+    uint64_t opponent;
+    int order;
+};
+
+static int orderMoves(uint64_t player, uint64_t opponent, uint64_t moves, int ttMove, EndgameCandidate *candidates)
+{
+    uint64_t parity = oddQuadrants(~(player | opponent));
+    int count = 0;
+    for (; moves; moves &= moves - 1)
+    {
+        int square = bitScanForward64(moves);
+        uint64_t bit = 1ull << square;
+        uint64_t flipped = OthelloBoard::flips(player, opponent, square);
+
+        EndgameCandidate candidate;
+        candidate.square = square;
+        candidate.player = opponent & ~flipped;
+        candidate.opponent = player | flipped | bit;
+        // fastest first, then parity
+        candidate.order = -16 * popCount64(OthelloBoard::legalMoves(candidate.player, candidate.opponent));
+        if (bit & parity)
+        {
+            candidate.order += 8;
+        }
+        if (square == ttMove)
+        {
+            candidate.order = 1 << 20;
+        }
+
+        // insertion sort, there are rarely more than a dozen moves this late
+        int i = count++;
+        while (i > 0 && candidates[i - 1].order < candidate.order)
+        {
+            candidates[i] = candidates[i - 1];
+            i--;
+        }
+        candidates[i] = candidate;
+    }
+    return count;
+}
+
+//
+// two passes: a window of -1..1 first, which only asks win, draw or loss and is several times cheaper,
+// then the full disc count. both passes share the table, so the second one starts well ordered. when the clock
+// stops the second pass the win/draw/loss answer is still a perfect move.
+//
+OthelloEndgameResult OthelloEndgame::solve(const OthelloBoard &board, int64_t timeMs)
+{
+    OthelloEndgameResult result;
+    _nodes = 0;
+    // entries from earlier solves are deeper than anything this one stores, they only keep their slots while
+    // they're from the current generation
+    _tt.newSearch();
+    _stopped = false;
+    _hasDeadline = timeMs > 0;
+    _deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeMs);
+
+    if (!board.legalMoves())
+    {
+        int score = -solve(board.opponent, board.player, -kScoreBound, kScoreBound, true);
+        result.completed = result.exact = !_stopped;
+        result.score = score;
+        result.nodes = _nodes;
+        return result;
+    }
+
+    int move, score;
+    if (solveRoot(board, -1, 1, move, score))
+    {
+        result.completed = true;
+        result.move = move;
+        result.score = score;
+        if (solveRoot(board, -kScoreBound, kScoreBound, move, score))
+        {
+            result.exact = true;
+            result.move = move;
+            result.score = score;
+        }
+    }
+    result.nodes = _nodes;
+    return result;
+}
+
+// searches every root move inside the window, false if the clock ran out first
+bool OthelloEndgame::solveRoot(const OthelloBoard &board, int alpha, int beta, int &bestMove, int &bestScore)
+{
+    int ttMove = -1;
+    if (const TTEntry<int> *entry = _tt.probe(board.hash()))
+    {
+        ttMove = entry->move;
+    }
+    EndgameCandidate candidates[64];
+    int count = orderMoves(board.player, board.opponent, board.legalMoves(), ttMove, candidates);
+
+    int alphaStart = alpha;
+    bestScore = -kScoreBound;
+    bestMove = candidates[0].square;
+    for (int i = 0; i < count; i++)
+    {
+        int score = -solve(candidates[i].player, candidates[i].opponent, -beta, -alpha, false);
+        if (_stopped)
+        {
+            return false;
+        }
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = candidates[i].square;
+            if (score > alpha)
+            {
+                alpha = score;
+                if (alpha >= beta)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    TTBound bound = bestScore <= alphaStart ? TTBoundUpper : (bestScore >= beta ? TTBoundLower : TTBoundExact);
+    _tt.store(board.hash(), 64 - popCount64(board.player | board.opponent), bestScore, bound, bestMove);
+    return true;
+}
+
+int OthelloEndgame::solve(uint64_t player, uint64_t opponent, int alpha, int beta, bool passed)
+{
+    if ((++_nodes & 4095) == 0 && timeUp())
+    {
+        _stopped = true;
+    }
+    if (_stopped)
+    {
+        return 0;
+    }
+
+    int empties = 64 - popCount64(player | opponent);
+    if (empties <= kParityOnlyEmpties)
+    {
+        return solveParity(player, opponent, alpha, beta, passed, empties);
+    }
+
+    uint64_t moves = OthelloBoard::legalMoves(player, opponent);
+    if (!moves)
+    {
+        if (passed)
+        {
+            return finalScore(player, opponent);
+        }
+        return -solve(opponent, player, -beta, -alpha, true);
+    }
+
+    // every stored score is exact to the end of the game, so the depth always matches
+    uint64_t key = OthelloBoard{ player, opponent }.hash();
+    int ttMove = -1;
+    if (const TTEntry<int> *entry = _tt.probe(key))
+    {
+        ttMove = entry->move;
+        if (entry->bound == TTBoundExact)
+            return entry->score;
+        if (entry->bound == TTBoundLower)
+            alpha = std::max(alpha, (int)entry->score);
+        else if (entry->bound == TTBoundUpper)
+            beta = std::min(beta, (int)entry->score);
+        if (alpha >= beta)
+        {
+            return entry->score;
+        }
+    }
+
+    EndgameCandidate candidates[64];
+    int count = orderMoves(player, opponent, moves, ttMove, candidates);
+
+    int alphaStart = alpha;
+    int bestScore = -kScoreBound;
+    int bestMove = candidates[0].square;
+    for (int i = 0; i < count; i++)
+    {
+        int score = -solve(candidates[i].player, candidates[i].opponent, -beta, -alpha, false);
+        if (_stopped)
+        {
+            return 0;
+        }
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = candidates[i].square;
+            if (score > alpha)
+            {
+                alpha = score;
+                if (alpha >= beta)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    TTBound bound = bestScore <= alphaStart ? TTBoundUpper : (bestScore >= beta ? TTBoundLower : TTBoundExact);
+    _tt.store(key, empties, bestScore, bound, bestMove);
+    return bestScore;
+}
+
+//
+// the last few empties: no table and no mobility counts, empty squares are simply tried
+// odd quadrants first and a square that flips nothing is not a move
+//
+int OthelloEndgame::solveParity(uint64_t player, uint64_t opponent, int alpha, int beta, bool passed, int empties)
+{
+    uint64_t empty = ~(player | opponent);
+    if (empties == 1)
+    {
+        return solveLastMove(player, opponent, bitScanForward64(empty));
+    }
+    _nodes++;
+
+    uint64_t parity = oddQuadrants(empty);
+    uint64_t groups[2] = { empty & parity, empty & ~parity };
+    int bestScore = -kScoreBound;
+    bool moved = false;
+    for (uint64_t squares : groups)
+    {
+        for (; squares; squares &= squares - 1)
+        {
+            int square = bitScanForward64(squares);
+            uint64_t flipped = OthelloBoard::flips(player, opponent, square);
+            if (!flipped)
+            {
+                continue;
+            }
+            moved = true;
+            int score = -solveParity(opponent & ~flipped, player | flipped | (1ull << square), -beta, -alpha, false, empties - 1);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                if (score > alpha)
+                {
+                    alpha = score;
+                    if (alpha >= beta)
+                    {
+                        return bestScore;
+                    }
+                }
+            }
+        }
+    }
+
+    if (!moved)
+    {
+        if (passed)
+        {
+            return finalScore(player, opponent);
+        }
+        return -solveParity(opponent, player, -beta, -alpha, true, empties);
+    }
+    return bestScore;
+}
+
+// one empty square left: whoever can play it does, no search needed
+int OthelloEndgame::solveLastMove(uint64_t player, uint64_t opponent, int square)
+{
+    _nodes++;
+    int diff = popCount64(player) - popCount64(opponent);
+    if (uint64_t flipped = OthelloBoard::flips(player, opponent, square))
+    {
+        return diff + 2 * popCount64(flipped) + 1;
+    }
+    if (uint64_t flipped = OthelloBoard::flips(opponent, player, square))
+    {
+        return diff - 2 * popCount64(flipped) - 1;
+    }
+    return diff > 0 ? diff + 1 : (diff < 0 ? diff - 1 : 0);
+}
+
+bool OthelloEndgame::timeUp()
+{
+    return _hasDeadline && std::chrono::steady_clock::now() >= _deadline;
+}
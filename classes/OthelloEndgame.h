@@ -0,0 +1,51 @@
+#pragma once
+
+#include "OthelloBoard.h"
+#include <chrono>
+
+//
+// exact othello endgame solver
+// once few enough squares are left the game is searched to the very end and scored by the final disc difference,
+// so the move it returns is perfect play. move ordering does most of the work:
+//   - the transposition table move first
+//   - fastest first, moves that leave the opponent the fewest replies are tried first
+//   - parity, moves into quadrants with an odd number of empties are preferred, the last move in a region is worth having
+// near the leaves the ordering costs more than it saves, so the last few empties are searched in parity order only.
+//
+struct OthelloEndgameResult
+{
+    // false when the time budget ran out before even the win/draw/loss result was known
+    bool completed = false;
+    // true once the disc count is exact as well, otherwise score only has the right sign
+    bool exact = false;
+    // square to play, or OthelloSearchTraits::kPass
+    int move = OthelloSearchTraits::kPass;
+    // final disc difference with best play, from the side to move, empty squares go to the winner
+    int score = 0;
+    uint64_t nodes = 0;
+};
+
+class OthelloEndgame
+{
+public:
+    // the AI hands a position over to the solver at this many empties
+    static constexpr int kMaxEmpties = 20;
+
+    explicit OthelloEndgame(size_t ttEntries = 1 << 18) : _tt(ttEntries) {}
+
+    // timeMs of 0 means no limit
+    OthelloEndgameResult solve(const OthelloBoard &board, int64_t timeMs);
+
+private:
+    bool solveRoot(const OthelloBoard &board, int alpha, int beta, int &bestMove, int &bestScore);
+    int solve(uint64_t player, uint64_t opponent, int alpha, int beta, bool passed);
+    int solveParity(uint64_t player, uint64_t opponent, int alpha, int beta, bool passed, int empties);
+    int solveLastMove(uint64_t player, uint64_t opponent, int square);
+    bool timeUp();
+
+    TranspositionTable<int> _tt;
+    std::chrono::steady_clock::time_point _deadline;
+    bool _hasDeadline = false;
+    bool _stopped = false;
+    uint64_t _nodes = 0;
+};
@@ -0,0 +1,168 @@
+#include "Profiler.h"
+
+#if PROFILER_ENABLED
+
+#include "../imgui/imgui.h"
+#include <atomic>
+#include <algorithm>
+
+namespace Profiler
+{
+    // ring buffer sizes, both must be powers of two
+    static const uint64_t kRingSize = 4096;
+    static const int kHistoryFrames = 512;
+
+    static const char *kZoneNames[ZoneCount] = {
+        "RenderGame",
+        "scanForMouse",
+        "drawFrame collect",
+        "drawFrame submit",
+        "canBitMoveFromTo",
+        "updateAI"
+    };
+
+    //
+    // each slot is published by storing its sequence number last, so the reader can tell
+    // a finished sample from one that is still being written or has already been overwritten
+    //
+    struct Sample
+    {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> packed{0};
+    };
+
+    static Sample _ring[kRingSize];
+    static std::atomic<uint64_t> _head{0};
+    static uint64_t _tail = 0;
+
+    // per frame totals, only touched by the render thread
+    static uint64_t _frameTotals[ZoneCount] = {0};
+    static uint32_t _frameHits[ZoneCount] = {0};
+    static float _historyMs[ZoneCount][kHistoryFrames] = {{0}};
+    static uint32_t _historyHits[ZoneCount][kHistoryFrames] = {{0}};
+    static uint64_t _frameNumber = 0;
+    static int _windowFrames = 120;
+
+    // zone id lives in the top byte, the duration in the remaining 56 bits
+    static uint64_t pack(Zone zone, uint64_t nanoseconds)
+    {
+        return ((uint64_t)zone << 56) | (nanoseconds & 0x00FFFFFFFFFFFFFFull);
+    }
+
+    void record(Zone zone, uint64_t nanoseconds)
+    {
+        uint64_t index = _head.fetch_add(1, std::memory_order_relaxed);
+        Sample &sample = _ring[index & (kRingSize - 1)];
+        sample.packed.store(pack(zone, nanoseconds), std::memory_order_relaxed);
+        sample.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    static void drain()
+    {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        // if the writers lapped us, the oldest samples are gone
+        if (head - _tail > kRingSize)
+        {
+            _tail = head - kRingSize;
+        }
+        while (_tail < head)
+        {
+            Sample &sample = _ring[_tail & (kRingSize - 1)];
+            uint64_t sequence = sample.sequence.load(std::memory_order_acquire);
+            if (sequence < _tail + 1)
+            {
+                // still being written, pick it up next frame
+                break;
+            }
+            uint64_t packed = sample.packed.load(std::memory_order_relaxed);
+            if (sequence == _tail + 1 && sample.sequence.load(std::memory_order_acquire) == sequence)
+            {
+                int zone = (int)(packed >> 56);
+                if (zone < ZoneCount)
+                {
+                    _frameTotals[zone] += packed & 0x00FFFFFFFFFFFFFFull;
+                    _frameHits[zone]++;
+                }
+            }
+            _tail++;
+        }
+    }
+
+    void endFrame()
+    {
+        drain();
+        int slot = (int)(_frameNumber & (kHistoryFrames - 1));
+        for (int zone = 0; zone < ZoneCount; zone++)
+        {
+            _historyMs[zone][slot] = (float)(_frameTotals[zone] / 1.0e6);
+            _historyHits[zone][slot] = _frameHits[zone];
+            _frameTotals[zone] = 0;
+            _frameHits[zone] = 0;
+        }
+        _frameNumber++;
+    }
+
+    void drawOverlay()
+    {
+        ImGui::Begin("Profiler");
+        ImGui::SliderInt("Frames", &_windowFrames, 1, kHistoryFrames);
+
+        int frames = (int)std::min<uint64_t>(_frameNumber, (uint64_t)_windowFrames);
+        float samples[kHistoryFrames];
+
+        if (ImGui::BeginTable("zones", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("Calls/frame");
+            ImGui::TableSetupColumn("Min ms");
+            ImGui::TableSetupColumn("Avg ms");
+            ImGui::TableSetupColumn("P99 ms");
+            ImGui::TableHeadersRow();
+
+            for (int zone = 0; zone < ZoneCount; zone++)
+            {
+                // only frames in which the zone actually ran count towards its statistics
+                int count = 0;
+                uint32_t calls = 0;
+                double sum = 0.0;
+                for (int i = 1; i <= frames; i++)
+                {
+                    int slot = (int)((_frameNumber - i) & (kHistoryFrames - 1));
+                    if (_historyHits[zone][slot])
+                    {
+                        samples[count++] = _historyMs[zone][slot];
+                        sum += _historyMs[zone][slot];
+                        calls += _historyHits[zone][slot];
+                    }
+                }
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(kZoneNames[zone]);
+                if (count == 0)
+                {
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted("-");
+                    continue;
+                }
+                int p99 = std::min(count - 1, (int)(count * 0.99f));
+                std::nth_element(samples, samples + p99, samples + count);
+                float p99Value = samples[p99];
+                float minValue = *std::min_element(samples, samples + count);
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", (float)calls / count);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", minValue);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", (float)(sum / count));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", p99Value);
+            }
+            ImGui::EndTable();
+        }
+        ImGui::End();
+    }
+}
+
+#endif
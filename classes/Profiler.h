@@ -0,0 +1,72 @@
+#pragma once
+
+//
+// lightweight scoped profiling zones for the frame loop
+// a PROFILE_ZONE times the enclosing scope and pushes the sample into a lock-free ring buffer,
+// the render thread drains it once per frame and the overlay shows min/avg/p99 per zone.
+// everything compiles out in release builds (NDEBUG) unless PROFILER_ENABLED is defined to 1.
+//
+#ifndef PROFILER_ENABLED
+#ifdef NDEBUG
+#define PROFILER_ENABLED 0
+#else
+#define PROFILER_ENABLED 1
+#endif
+#endif
+
+#if PROFILER_ENABLED
+
+#include <chrono>
+#include <cstdint>
+
+namespace Profiler
+{
+    enum Zone
+    {
+        ZoneFrame,
+        ZoneScanForMouse,
+        ZoneDrawCollect,
+        ZoneDrawSubmit,
+        ZoneCanBitMoveFromTo,
+        ZoneUpdateAI,
+        ZoneCount
+    };
+
+    // safe to call from any thread
+    void record(Zone zone, uint64_t nanoseconds);
+    // called once per frame by the render thread, folds the samples recorded since the last call into the frame history
+    void endFrame();
+    // imgui window with per-zone statistics
+    void drawOverlay();
+
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(Zone zone) : _zone(zone), _start(std::chrono::steady_clock::now()) {}
+        ~ScopedZone()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - _start;
+            record(_zone, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+        ScopedZone(const ScopedZone &) = delete;
+        ScopedZone &operator=(const ScopedZone &) = delete;
+
+    private:
+        Zone _zone;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(zone) Profiler::ScopedZone PROFILE_CONCAT(_profileZone, __LINE__)(Profiler::zone)
+#define PROFILE_END_FRAME() Profiler::endFrame()
+#define PROFILE_DRAW_OVERLAY() Profiler::drawOverlay()
+
+#else
+
+#define PROFILE_ZONE(zone) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#define PROFILE_DRAW_OVERLAY() ((void)0)
+
+#endif
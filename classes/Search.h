@@ -0,0 +1,654 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "MappedFile.h"
+
+//
+// generic game tree search shared by all of the games
+// a game plugs in a traits class made of static functions, so everything in the inner loop is resolved at compile time:
+//
+//   struct MyTraits {
+//       using Position = ...;                  // mutable position, made/unmade in place
+//       using Move = ...;                      // small, default constructible, comparable with ==
+//       using Undo = ...;                      // whatever makeMove needs to restore the position
+//       static constexpr int kMaxMoves;        // upper bound on moves in a position
+//       static constexpr int kMoveIndexSize;   // moveIndex() range, sizes the history table
+//       static int      generateMoves(const Position &pos, Move *moves);      // returns the count
+//       static void     makeMove(Position &pos, const Move &move, Undo &undo);
+//       static void     unmakeMove(Position &pos, const Move &move, const Undo &undo);
+//       static int      evaluate(const Position &pos);                        // from the side to move's point of view
+//       static bool     isTerminal(const Position &pos, int &score);          // game over? score for the side to move
+//       static int      noMovesScore(const Position &pos);                    // score when generateMoves returns 0
+//       static uint64_t hash(const Position &pos);
+//       static int      orderScore(const Position &pos, const Move &move);    // > 0 for tactical moves, searched first
+//       static int      moveIndex(const Move &move);
+//
+//       // optional, scores from an endgame table. only used while the root is outside the table: once the game
+//       // is inside it, the caller narrows the root moves to the ones that keep the table result and the search
+//       // looks for progress among them
+//       static bool     probe(const Position &pos, int &score);
+//   };
+//
+// wins and losses are reported as +/- SearchScore::kWin, the search folds in the distance so faster wins score higher.
+//
+
+namespace SearchScore
+{
+    constexpr int kInfinity = 1000000;
+    constexpr int kWin = 900000;
+    // anything beyond this is a forced win or loss
+    constexpr int kWinThreshold = kWin - 1000;
+}
+
+// deterministic hash keys (splitmix64), used to build zobrist style position hashes without a table
+inline uint64_t zobristKey(uint64_t index)
+{
+    uint64_t z = index * 0x9E3779B97F4A7C15ull + 0x632BE59BD9B4E019ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+//
+// the search stops at whichever limit it reaches first and plays the last depth that finished. depth 1 always
+// finishes so there's a move, it's a handful of nodes
+//
+struct SearchLimits
+{
+    int maxDepth = 64;
+    // hard wall clock deadline in milliseconds, the search stops where it is. 0 means no limit
+    int64_t timeMs = 0;
+    // no new depth is started after this many milliseconds, 0 means half of timeMs:
+    // the next depth usually costs more than all of the earlier ones together
+    int64_t softTimeMs = 0;
+    // hard node budget, 0 means no limit. like the clock, no new depth is started past half of it
+    uint64_t maxNodes = 0;
+    // nodes between looks at the clock and the stop flag, reading the clock costs a lot more than a node
+    int clockCheckNodes = 1024;
+    // the same position and limits always give the same move: the search forgets what earlier searches learned
+    // and never reads the clock, so only maxDepth and maxNodes limit it. forgetting includes a table loaded from
+    // a file, chess_ai.tt is thrown away the first time it's searched this way
+    bool deterministic = false;
+    // how many of the best root moves to report, each with its own exact score and line
+    int multiPV = 1;
+    // another thread sets this to end the search early
+    const std::atomic<bool> *stop = nullptr;
+};
+
+// one root move and the line the search expects to follow it
+template <typename Move>
+struct SearchLine
+{
+    Move move{};
+    int score = 0;
+    std::vector<Move> pv;
+};
+
+template <typename Move>
+struct SearchResult
+{
+    bool hasMove = false;
+    Move bestMove{};
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    // wall clock time since the search started
+    int64_t timeMs = 0;
+    std::vector<Move> pv;
+    // best first, limits.multiPV of them or fewer when the root has fewer moves. lines[0] is bestMove
+    std::vector<SearchLine<Move>> lines;
+};
+
+enum TTBound : uint8_t
+{
+    TTBoundNone,
+    TTBoundExact,
+    TTBoundLower,
+    TTBoundUpper
+};
+
+template <typename Move>
+struct TTEntry
+{
+    uint64_t key = 0;
+    Move move{};
+    int32_t score = 0;
+    int16_t depth = 0;
+    uint8_t bound = TTBoundNone;
+    // the search that stored it, older entries give way to anything from the current one
+    uint8_t generation = 0;
+};
+
+// what TranspositionTable::save writes ahead of the entries
+struct TTFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryBytes;
+    uint32_t generation;
+    uint64_t entries;
+};
+
+//
+// one entry per slot, kept between searches. each search is a new generation: within a search a slot keeps the
+// deeper of two positions, but an entry left over from an earlier search is replaced by anything, so the table
+// fills with the current game without forgetting what still helps. the table can be saved to a file and mapped
+// back in later, the keys come from zobristKey so they mean the same thing from one run to the next
+//
+template <typename Move>
+class TranspositionTable
+{
+public:
+    static constexpr uint32_t kFileVersion = 1;
+
+    explicit TranspositionTable(size_t entries) { resize(entries); }
+
+    // rounded down to a power of two
+    void resize(size_t entries)
+    {
+        size_t size = 1;
+        while (size * 2 <= entries)
+        {
+            size *= 2;
+        }
+        _entries.assign(size, TTEntry<Move>());
+        _mask = size - 1;
+    }
+    void clear() { std::fill(_entries.begin(), _entries.end(), TTEntry<Move>()); }
+    size_t size() const { return _entries.size(); }
+    // called as each search starts
+    void newSearch() { _generation++; }
+
+    const TTEntry<Move> *probe(uint64_t key) const
+    {
+        const TTEntry<Move> &entry = _entries[key & _mask];
+        return (entry.bound != TTBoundNone && entry.key == key) ? &entry : nullptr;
+    }
+
+    void store(uint64_t key, int depth, int score, TTBound bound, const Move &move)
+    {
+        TTEntry<Move> &entry = _entries[key & _mask];
+        if (entry.bound != TTBoundNone && depth < entry.depth)
+        {
+            // keep a deeper result for the same position unless the new one is exact,
+            // and a deeper one for another position stored by this search
+            bool samePosition = entry.key == key;
+            if ((samePosition && bound != TTBoundExact) || (!samePosition && entry.generation == _generation))
+            {
+                return;
+            }
+        }
+        entry.key = key;
+        entry.move = move;
+        entry.score = score;
+        entry.depth = (int16_t)depth;
+        entry.bound = bound;
+        entry.generation = _generation;
+    }
+
+    bool save(const char *path) const
+    {
+        static_assert(std::is_trivially_copyable_v<TTEntry<Move>>, "table entries are written as raw bytes");
+        FILE *file = fopen(path, "wb");
+        if (!file)
+        {
+            return false;
+        }
+        TTFileHeader header = { {'T', 'T', 'B', 'L'}, kFileVersion, (uint32_t)sizeof(TTEntry<Move>), _generation, _entries.size() };
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                       fwrite(_entries.data(), sizeof(TTEntry<Move>), _entries.size(), file) == _entries.size();
+        return fclose(file) == 0 && written;
+    }
+
+    // false, leaving the table as it was, when the file is missing or was written for another kind of entry
+    bool load(const char *path)
+    {
+        MappedFile file;
+        if (!file.open(path))
+        {
+            return false;
+        }
+        TTFileHeader header;
+        if (file.size() < sizeof(header))
+        {
+            return false;
+        }
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, "TTBL", 4) != 0 || header.version != kFileVersion || header.entryBytes != sizeof(TTEntry<Move>) ||
+            header.entries > (file.size() - sizeof(header)) / sizeof(TTEntry<Move>))
+        {
+            return false;
+        }
+
+        const TTEntry<Move> *entries = (const TTEntry<Move> *)(file.data() + sizeof(header));
+        if (header.entries == _entries.size())
+        {
+            memcpy(_entries.data(), entries, _entries.size() * sizeof(TTEntry<Move>));
+        }
+        else
+        {
+            // saved at another size, every entry goes to its slot in this one
+            clear();
+            for (uint64_t i = 0; i < header.entries; i++)
+            {
+                if (entries[i].bound != TTBoundNone)
+                {
+                    _entries[entries[i].key & _mask] = entries[i];
+                }
+            }
+        }
+        // the next search starts a generation after the saved ones, so it can replace them
+        _generation = (uint8_t)header.generation;
+        return true;
+    }
+
+private:
+    std::vector<TTEntry<Move>> _entries;
+    size_t _mask;
+    uint8_t _generation = 0;
+};
+
+template <typename Traits>
+class Search
+{
+public:
+    using Position = typename Traits::Position;
+    using Move = typename Traits::Move;
+    using Undo = typename Traits::Undo;
+
+    static constexpr int kMaxPly = 64;
+
+    explicit Search(size_t ttEntries = 1 << 16) : _tt(ttEntries), _history(Traits::kMoveIndexSize, 0) {}
+
+    // forget everything learned from earlier searches
+    void clear()
+    {
+        _tt.clear();
+        std::fill(_history.begin(), _history.end(), 0);
+    }
+
+    TranspositionTable<Move> &table() { return _tt; }
+
+    // called with the result so far each time a depth completes, for showing the lines while the search runs
+    void onIteration(std::function<void(const SearchResult<Move> &)> report) { _onIteration = std::move(report); }
+
+    //
+    // iterative deepening alpha-beta from the given position
+    // the position is restored before returning. rootMoves, when given, limits the moves tried at the root
+    // with multiPV above 1 every depth searches the root again for each line, leaving out the root moves already
+    // found at that depth. the table, killers and history carry over between the lines, so the later ones are cheap
+    //
+    SearchResult<Move> run(Position &position, const SearchLimits &limits, const std::vector<Move> *rootMoves = nullptr)
+    {
+        SearchResult<Move> result;
+        _limits = limits;
+        _rootMoves = rootMoves;
+        if constexpr (hasTable)
+        {
+            int score;
+            bool useTable = !Traits::probe(position, score);
+            // table and heuristic scores don't mix, start over when switching between them
+            if (useTable != _useTable)
+            {
+                _tt.clear();
+            }
+            _useTable = useTable;
+        }
+        if (limits.deterministic)
+        {
+            clear();
+        }
+        _tt.newSearch();
+        _start = std::chrono::steady_clock::now();
+        _nodes = 0;
+        _clockCountdown = std::max(1, limits.clockCheckNodes);
+        _stopped = false;
+        _canStop = false;
+        for (int ply = 0; ply < kMaxPly; ply++)
+        {
+            _killers[ply][0] = _killers[ply][1] = Move();
+        }
+        // age the history so old cutoffs don't dominate
+        for (auto &value : _history)
+        {
+            value /= 8;
+        }
+
+        int maxDepth = std::min(limits.maxDepth, kMaxPly - 1);
+        int lineCount = std::max(1, limits.multiPV);
+        std::vector<SearchLine<Move>> lines;
+        for (int depth = 1; depth <= maxDepth; depth++)
+        {
+            lines.clear();
+            _excluded.clear();
+            for (int line = 0; line < lineCount; line++)
+            {
+                int score = alphaBeta(position, depth, 0, -SearchScore::kInfinity, SearchScore::kInfinity);
+                if (_stopped || _pvLength[0] == 0)
+                {
+                    // out of time, or no root moves left to try
+                    break;
+                }
+                lines.push_back({_pv[0][0], score, std::vector<Move>(_pv[0], _pv[0] + _pvLength[0])});
+                _excluded.push_back(_pv[0][0]);
+            }
+            _excluded.clear();
+            if (_stopped)
+            {
+                // a depth that didn't finish every line is dropped, the lines would be from different depths
+                break;
+            }
+            if (lines.empty())
+            {
+                // terminal or moveless root, nothing to play
+                break;
+            }
+            // each line had the full window so its score is exact, but the table can still shuffle near equal ones
+            std::stable_sort(lines.begin(), lines.end(), [](const SearchLine<Move> &a, const SearchLine<Move> &b) { return a.score > b.score; });
+            int score = lines[0].score;
+            result.hasMove = true;
+            result.bestMove = lines[0].move;
+            result.score = score;
+            result.depth = depth;
+            result.pv = lines[0].pv;
+            result.lines = lines;
+            if (_onIteration)
+            {
+                result.nodes = _nodes;
+                result.timeMs = elapsedMs();
+                _onIteration(result);
+            }
+
+            // depth 1 always completes so there is a move to play, after that the clock may stop us
+            _canStop = true;
+            if (score >= SearchScore::kWinThreshold || score <= -SearchScore::kWinThreshold)
+            {
+                break;
+            }
+            if (pastSoftLimit())
+            {
+                break;
+            }
+        }
+        result.nodes = _nodes;
+        result.timeMs = elapsedMs();
+        return result;
+    }
+
+private:
+    static constexpr bool hasTable = requires(const Position &position, int &score) { Traits::probe(position, score); };
+
+    int alphaBeta(Position &position, int depth, int ply, int alpha, int beta)
+    {
+        _pvLength[ply] = 0;
+        if (_canStop && _limits.maxNodes > 0 && _nodes >= _limits.maxNodes)
+        {
+            _stopped = true;
+        }
+        else
+        {
+            _nodes++;
+            if (--_clockCountdown <= 0)
+            {
+                _clockCountdown = std::max(1, _limits.clockCheckNodes);
+                if (timeUp() || stopRequested())
+                {
+                    _stopped = true;
+                }
+            }
+        }
+        if (_stopped)
+        {
+            return 0;
+        }
+
+        int terminalScore;
+        if (Traits::isTerminal(position, terminalScore))
+        {
+            return adjustForPly(terminalScore, ply);
+        }
+        if constexpr (hasTable)
+        {
+            int tableScore;
+            if (ply > 0 && _useTable && Traits::probe(position, tableScore))
+            {
+                return tableScore;
+            }
+        }
+        if (depth <= 0 || ply >= kMaxPly - 1)
+        {
+            return Traits::evaluate(position);
+        }
+
+        uint64_t key = Traits::hash(position);
+        bool hasTTMove = false;
+        Move ttMove{};
+        if (const TTEntry<Move> *entry = _tt.probe(key))
+        {
+            hasTTMove = true;
+            ttMove = entry->move;
+            if (ply > 0 && entry->depth >= depth)
+            {
+                int score = scoreFromTT(entry->score, ply);
+                if (entry->bound == TTBoundExact ||
+                    (entry->bound == TTBoundLower && score >= beta) ||
+                    (entry->bound == TTBoundUpper && score <= alpha))
+                {
+                    return score;
+                }
+            }
+        }
+
+        Move moves[Traits::kMaxMoves];
+        int count = Traits::generateMoves(position, moves);
+        if (ply == 0 && _rootMoves)
+        {
+            count = (int)(std::remove_if(moves, moves + count, [&](const Move &move) {
+                return std::find(_rootMoves->begin(), _rootMoves->end(), move) == _rootMoves->end();
+            }) - moves);
+        }
+        if (ply == 0 && !_excluded.empty())
+        {
+            count = (int)(std::remove_if(moves, moves + count, [&](const Move &move) {
+                return std::find(_excluded.begin(), _excluded.end(), move) != _excluded.end();
+            }) - moves);
+            if (count == 0)
+            {
+                return -SearchScore::kInfinity;
+            }
+        }
+        if (count == 0)
+        {
+            return adjustForPly(Traits::noMovesScore(position), ply);
+        }
+
+        int scores[Traits::kMaxMoves];
+        scoreMoves(position, moves, scores, count, hasTTMove, ttMove, ply);
+
+        int alphaStart = alpha;
+        int bestScore = -SearchScore::kInfinity;
+        Move bestMove = moves[0];
+        for (int i = 0; i < count; i++)
+        {
+            pickNext(moves, scores, i, count);
+            const Move &move = moves[i];
+
+            Undo undo;
+            Traits::makeMove(position, move, undo);
+            int score = -alphaBeta(position, depth - 1, ply + 1, -beta, -alpha);
+            Traits::unmakeMove(position, move, undo);
+            if (_stopped)
+            {
+                return 0;
+            }
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestMove = move;
+                if (score > alpha)
+                {
+                    alpha = score;
+                    updatePV(ply, move);
+                    if (alpha >= beta)
+                    {
+                        if (Traits::orderScore(position, move) <= 0)
+                        {
+                            rememberCutoff(move, depth, ply);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        // a root searched without some of its moves doesn't have the root's real score
+        if (ply > 0 || _excluded.empty())
+        {
+            TTBound bound = bestScore <= alphaStart ? TTBoundUpper : (bestScore >= beta ? TTBoundLower : TTBoundExact);
+            _tt.store(key, depth, scoreToTT(bestScore, ply), bound, bestMove);
+        }
+        return bestScore;
+    }
+
+    //
+    // move ordering: hash move, then tactical moves by the game's own score, then killers, then history
+    //
+    void scoreMoves(const Position &position, const Move *moves, int *scores, int count, bool hasTTMove, const Move &ttMove, int ply)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const Move &move = moves[i];
+            int tactical = Traits::orderScore(position, move);
+            if (hasTTMove && move == ttMove)
+                scores[i] = 1 << 30;
+            else if (tactical > 0)
+                scores[i] = (1 << 28) + std::min(tactical, 1 << 20);
+            else if (move == _killers[ply][0])
+                scores[i] = (1 << 27) + 1;
+            else if (move == _killers[ply][1])
+                scores[i] = 1 << 27;
+            else
+                scores[i] = _history[Traits::moveIndex(move)];
+        }
+    }
+
+    // selection sort step, cheap because cutoffs usually come from the first few moves
+    static void pickNext(Move *moves, int *scores, int index, int count)
+    {
+        int best = index;
+        for (int i = index + 1; i < count; i++)
+        {
+            if (scores[i] > scores[best])
+            {
+                best = i;
+            }
+        }
+        if (best != index)
+        {
+            std::swap(moves[index], moves[best]);
+            std::swap(scores[index], scores[best]);
+        }
+    }
+
+    void rememberCutoff(const Move &move, int depth, int ply)
+    {
+        if (!(move == _killers[ply][0]))
+        {
+            _killers[ply][1] = _killers[ply][0];
+            _killers[ply][0] = move;
+        }
+        int &history = _history[Traits::moveIndex(move)];
+        history = std::min(history + depth * depth, (1 << 26));
+    }
+
+    void updatePV(int ply, const Move &move)
+    {
+        _pv[ply][0] = move;
+        int childLength = _pvLength[ply + 1];
+        for (int i = 0; i < childLength; i++)
+        {
+            _pv[ply][i + 1] = _pv[ply + 1][i];
+        }
+        _pvLength[ply] = childLength + 1;
+    }
+
+    static int adjustForPly(int score, int ply)
+    {
+        if (score >= SearchScore::kWinThreshold)
+            return score - ply;
+        if (score <= -SearchScore::kWinThreshold)
+            return score + ply;
+        return score;
+    }
+
+    // wins are stored relative to the node so they stay valid when reached at another ply
+    static int scoreToTT(int score, int ply)
+    {
+        if (score >= SearchScore::kWinThreshold)
+            return score + ply;
+        if (score <= -SearchScore::kWinThreshold)
+            return score - ply;
+        return score;
+    }
+
+    static int scoreFromTT(int score, int ply)
+    {
+        if (score >= SearchScore::kWinThreshold)
+            return score - ply;
+        if (score <= -SearchScore::kWinThreshold)
+            return score + ply;
+        return score;
+    }
+
+    int64_t elapsedMs() const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    bool timeUp() const { return _canStop && !_limits.deterministic && _limits.timeMs > 0 && elapsedMs() >= _limits.timeMs; }
+
+    // checked between depths, whether to stop rather than start the next one
+    bool pastSoftLimit() const
+    {
+        if (_limits.maxNodes > 0 && _nodes * 2 >= _limits.maxNodes)
+        {
+            return true;
+        }
+        if (_limits.deterministic)
+        {
+            return false;
+        }
+        int64_t softTimeMs = _limits.softTimeMs > 0 ? _limits.softTimeMs : _limits.timeMs / 2;
+        return softTimeMs > 0 && elapsedMs() >= softTimeMs;
+    }
+    bool stopRequested() const { return _limits.stop && _limits.stop->load(std::memory_order_relaxed); }
+
+    TranspositionTable<Move> _tt;
+    std::vector<int> _history;
+    Move _killers[kMaxPly][2];
+    // triangular principal variation table, _pv[ply] holds the line starting at that ply
+    Move _pv[kMaxPly][kMaxPly];
+    int _pvLength[kMaxPly];
+
+    SearchLimits _limits;
+    std::chrono::steady_clock::time_point _start;
+    uint64_t _nodes = 0;
+    int _clockCountdown = 0;
+    bool _stopped = false;
+    bool _canStop = false;
+    const std::vector<Move> *_rootMoves = nullptr;
+    // root moves already reported at the current depth, left out of the search for the next line
+    std::vector<Move> _excluded;
+    std::function<void(const SearchResult<Move> &)> _onIteration;
+    bool _useTable = true;
+};
@@ -1,30 +1,19 @@
 #include "Sprite.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
-#include <iostream>
-#include <filesystem>
+#include "TextureCache.h"
 
-// Simple helper function to load an image into a OpenGL texture with common settings
 bool Sprite::LoadTextureFromFile(const char* filename)
 {
-    // Load from file
-    int image_width = 0;
-    int image_height = 0;
-    std::filesystem::path resourcePath = std::filesystem::path("resources") / filename;
-    std::string newFilename = resourcePath.string();
-    unsigned char* image_data = stbi_load(newFilename.c_str(), &image_width, &image_height, NULL, 4);
-    if (image_data == NULL) {
+    const TextureCache::Texture *texture = TextureCache::find(filename);
+    if (texture == nullptr) {
         _size = ImVec2(0, 0);
-        std::cout << "Failed to load texture: " << newFilename << std::endl;
         return false;
     }
-    _texture = _loadTextureFromMemory(image_data, image_width, image_height);
-    stbi_image_free(image_data);
-    if (_texture == 0) {
-        _size = ImVec2(0, 0);
-        return false;
-    }
-    _size = ImVec2((float)image_width, (float)image_height);
+    _texture = texture->texture;
+    _uv0 = texture->uv0;
+    _uv1 = texture->uv1;
+    _size = texture->size;
     return true;
 }
 
@@ -35,15 +24,27 @@ void Sprite::setHighlighted(bool highlighted)
 	}
 }
 
-bool Sprite::highlighted()
+bool Sprite::highlighted() const
 {
 	return _highlighted;
 }
 
-#ifdef __APPLE__
+#if defined(SPRITE_HEADLESS)
+
+//
+// headless builds (benchmarks, batch tools) decode the image as usual but never touch a GPU,
+// each texture just gets a unique non-zero id
+//
+ImTextureID Sprite::uploadTexture(const unsigned char *image_data, int image_width, int image_height)
+{
+    static ImTextureID nextTexture = 0;
+    return ++nextTexture;
+}
+
+#elif defined(__APPLE__)
 #include "../imgui/imgui_impl_opengl3_loader.h"
 
-ImTextureID Sprite::_loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height)
+ImTextureID Sprite::uploadTexture(const unsigned char *image_data, int image_width, int image_height)
 {
     // Create a OpenGL texture identifier
     GLuint image_texture;
@@ -70,7 +71,7 @@ ImTextureID Sprite::_loadTextureFromMemory(const unsigned char *image_data, int
 #pragma comment(lib, "d3dcompiler") // Automatically link with d3dcompiler.lib as we are using D3DCompile() below.
 #endif
 
-ImTextureID Sprite::_loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height)
+ImTextureID Sprite::uploadTexture(const unsigned char *image_data, int image_width, int image_height)
 {
     // Create texture
     D3D11_TEXTURE2D_DESC desc;
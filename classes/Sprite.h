@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include "Entity.h"
 #include "../imgui/imgui.h"
 
@@ -16,6 +17,9 @@ public:
         _scale(1),
         _color(1, 1, 1, 1),
         _localZOrder(0),
+        _texture(0),
+        _uv0(0, 0),
+        _uv1(1, 1),
         _highlighted(false)
         { 
             _entityType = EntitySprite;
@@ -35,7 +39,12 @@ public:
     {
         _location = ImVec2(point.x - _size.x / 2, point.y - _size.y / 2);
     }
-    const ImVec2 &getPosition() { return _location; }
+    const ImVec2 &getPosition() const { return _location; }
+    const ImVec2 &getSize() const { return _size; }
+    ImTextureID getTexture() const { return _texture; }
+    const ImVec2 &getUV0() const { return _uv0; }
+    const ImVec2 &getUV1() const { return _uv1; }
+    const ImVec4 &getColor() const { return _color; }
 
     void setSize(float x, float y)
     {
@@ -66,7 +75,7 @@ public:
         {
             ImGui::SetCursorPos(_location);
             ImVec4 highlight = _highlighted ? ImVec4(1, 1, 0, 1) : ImVec4(0, 0, 0, 0);
-            ImGui::Image((void*)(intptr_t)_texture, _size, ImVec2(0, 0), ImVec2(1, 1), _color, highlight);
+            ImGui::Image((void*)(intptr_t)_texture, _size, _uv0, _uv1, _color, highlight);
         }
     }
 	// is the mouse over this position?
@@ -75,13 +84,16 @@ public:
         return (mousePos.x >= _location.x && mousePos.x <= _location.x + _size.x && mousePos.y >= _location.y && mousePos.y <= _location.y + _size.y);
     }
 
+    // takes the image from the shared texture cache, the file is only read the first time any sprite asks for it
     bool LoadTextureFromFile(const char* filename);
+    // platform specific upload of rgba pixels into a new texture
+    static ImTextureID uploadTexture(const unsigned char *image_data, int image_width, int image_height);
 	
     // set the highlighted state
 	virtual void	setHighlighted(bool yes);
 
 	// highlight the holder while a bit is being dragged to us
-	bool	highlighted();
+	bool	highlighted() const;
 
 protected:
     // the texture to use for this sprite
@@ -100,10 +112,10 @@ protected:
     ImVec4  _color;
     // the local Z order
     int _localZOrder;
-    // the texture we're going to draw
+    // the texture we're going to draw, and the part of it holding our image
     ImTextureID _texture;
+    ImVec2  _uv0;
+    ImVec2  _uv1;
     // currently highlighted
    	bool	_highlighted;
-    // private platform specific texture loading
-    ImTextureID _loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height);
 };
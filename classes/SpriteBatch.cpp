@@ -0,0 +1,65 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+
+// the outline around a highlighted sprite, as ImGui::Image draws it
+static const ImVec4 kHighlightColor(1, 1, 0, 1);
+static const float kHighlightBorder = 1.0f;
+
+void SpriteBatch::add(const Sprite &sprite, Layer layer)
+{
+    const ImVec2 &size = sprite.getSize();
+    if (size.x <= 0.0f || size.y <= 0.0f)
+    {
+        return;
+    }
+    Item item;
+    item.layer = (uint8_t)layer;
+    item.texture = sprite.getTexture();
+    item.order = (uint32_t)_items.size();
+    item.min = sprite.getPosition();
+    item.max = ImVec2(item.min.x + size.x, item.min.y + size.y);
+    item.uv0 = sprite.getUV0();
+    item.uv1 = sprite.getUV1();
+    item.color = sprite.getColor();
+    item.highlighted = sprite.highlighted();
+    _items.push_back(item);
+}
+
+void SpriteBatch::submit()
+{
+    std::sort(_items.begin(), _items.end(), [](const Item &a, const Item &b) {
+        if (a.layer != b.layer)
+            return a.layer < b.layer;
+        if (a.texture != b.texture)
+            return a.texture < b.texture;
+        return a.order < b.order;
+    });
+
+    // sprite positions are window local, the same space ImGui::SetCursorPos works in
+    ImVec2 cursor = ImGui::GetCursorPos();
+    ImVec2 screen = ImGui::GetCursorScreenPos();
+    ImVec2 origin(screen.x - cursor.x, screen.y - cursor.y);
+
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    ImVec2 extent(0, 0);
+    for (const Item &item : _items)
+    {
+        ImVec2 min(origin.x + item.min.x, origin.y + item.min.y);
+        ImVec2 max(origin.x + item.max.x, origin.y + item.max.y);
+        if (item.highlighted)
+        {
+            // the image sits inside its outline, like ImGui::Image with a border color
+            ImVec2 outer(max.x + 2 * kHighlightBorder, max.y + 2 * kHighlightBorder);
+            drawList->AddRect(min, outer, ImGui::GetColorU32(kHighlightColor), 0.0f, ImDrawFlags_None, kHighlightBorder);
+            min = ImVec2(min.x + kHighlightBorder, min.y + kHighlightBorder);
+            max = ImVec2(max.x + kHighlightBorder, max.y + kHighlightBorder);
+        }
+        drawList->AddImage(item.texture, min, max, item.uv0, item.uv1, ImGui::GetColorU32(item.color));
+        extent.x = std::max(extent.x, item.max.x);
+        extent.y = std::max(extent.y, item.max.y);
+    }
+
+    // one item covering the board, so the window still sizes and scrolls to fit it
+    ImGui::SetCursorPos(ImVec2(0, 0));
+    ImGui::Dummy(extent);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Sprite.h"
+#include <cstdint>
+#include <vector>
+
+//
+// collects the sprites of a frame and draws them straight into the window's ImDrawList
+// nothing is drawn until submit(), which orders the sprites by layer and then by texture. dear imgui
+// merges consecutive images with the same texture into one draw command, so a board whose sprites
+// share a texture costs one draw call however big it gets.
+//
+class SpriteBatch
+{
+public:
+    enum Layer
+    {
+        LayerBoard,
+        LayerPieces,
+        LayerMoving,
+        LayerPickedUp
+    };
+
+    void clear() { _items.clear(); }
+    void add(const Sprite &sprite, Layer layer);
+    // draws everything into the current window, where ImGui::SetCursorPos would have put it
+    void submit();
+
+    size_t size() const { return _items.size(); }
+
+private:
+    struct Item
+    {
+        // layer, then texture, then the order the sprites were added in
+        uint8_t     layer;
+        ImTextureID texture;
+        uint32_t    order;
+        ImVec2      min;
+        ImVec2      max;
+        ImVec2      uv0;
+        ImVec2      uv1;
+        ImVec4      color;
+        bool        highlighted;
+    };
+
+    // kept between frames so the storage is only allocated once
+    std::vector<Item> _items;
+};
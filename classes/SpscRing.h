@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+//
+// fixed size queue between exactly one writing thread and one reading thread, without locks
+// each side owns one index and only reads the other's, and keeps a copy of it so the shared cache line is
+// only touched when the queue looks full or empty. push never waits: when the reader has fallen a whole
+// ring behind, the record is dropped and push returns false
+//
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    // writer only
+    bool push(const T &value)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tailSeen == Capacity)
+        {
+            _tailSeen = _tail.load(std::memory_order_acquire);
+            if (head - _tailSeen == Capacity)
+            {
+                return false;
+            }
+        }
+        _slots[head & (Capacity - 1)] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // reader only, false when there's nothing waiting
+    bool pop(T &value)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _headSeen)
+        {
+            _headSeen = _head.load(std::memory_order_acquire);
+            if (tail == _headSeen)
+            {
+                return false;
+            }
+        }
+        value = _slots[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // the writer's line
+    alignas(64) std::atomic<size_t> _head{0};
+    size_t _tailSeen = 0;
+    // the reader's line
+    alignas(64) std::atomic<size_t> _tail{0};
+    size_t _headSeen = 0;
+    alignas(64) T _slots[Capacity];
+};
@@ -0,0 +1,240 @@
+#include "TextureCache.h"
+#include "Sprite.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// imgui_draw.cpp keeps its copy of the packer static, so this file compiles its own
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "../imgui/imstb_rectpack.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+// every image gets its edge pixels repeated this far around it, so filtering never samples a neighbour
+static const int kPadding = 1;
+// the atlas starts this big and doubles until everything fits
+static const int kMinAtlasSide = 256;
+static const int kMaxAtlasSide = 4096;
+
+namespace TextureCache
+{
+    static std::unordered_map<std::string, Texture> textures;
+    static bool atlasBuilt = false;
+    static ImVec2 packedSize(0, 0);
+
+    struct Image
+    {
+        std::string    name;
+        int            width = 0;
+        int            height = 0;
+        unsigned char *pixels = nullptr;
+    };
+
+    // the decode started by startLoading, the workers only ever write their own images and the counter
+    static bool loadingStarted = false;
+    static std::vector<Image> images;
+    static std::vector<std::thread> workers;
+    static std::atomic<int> nextImage(0);
+    static std::atomic<int> imagesDecoded(0);
+    static int imageCount = 0;
+
+    static std::string resourcePath(const std::string &name)
+    {
+        return (std::filesystem::path("resources") / name).string();
+    }
+
+    //
+    // copies an image into the atlas at x, y and repeats its outer pixels into the padding around it
+    //
+    static void blit(std::vector<unsigned char> &atlas, int atlasWidth, const Image &image, int x, int y)
+    {
+        for (int row = -kPadding; row < image.height + kPadding; row++)
+        {
+            int sourceRow = std::clamp(row, 0, image.height - 1);
+            for (int column = -kPadding; column < image.width + kPadding; column++)
+            {
+                int sourceColumn = std::clamp(column, 0, image.width - 1);
+                const unsigned char *source = image.pixels + (sourceRow * image.width + sourceColumn) * 4;
+                unsigned char *target = &atlas[((y + row) * atlasWidth + x + column) * 4];
+                memcpy(target, source, 4);
+            }
+        }
+    }
+
+    static void decodeImages()
+    {
+        for (int i = nextImage++; i < (int)images.size(); i = nextImage++)
+        {
+            Image &image = images[i];
+            image.pixels = stbi_load(resourcePath(image.name).c_str(), &image.width, &image.height, NULL, 4);
+            imagesDecoded++;
+        }
+    }
+
+    void startLoading()
+    {
+        if (loadingStarted)
+        {
+            return;
+        }
+        loadingStarted = true;
+
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator("resources", error))
+        {
+            if (entry.path().extension() == ".png")
+            {
+                Image image;
+                image.name = entry.path().filename().string();
+                images.push_back(image);
+            }
+        }
+        // directory order differs between systems, sorting keeps the layout the same everywhere
+        std::sort(images.begin(), images.end(), [](const Image &a, const Image &b) { return a.name < b.name; });
+        imageCount = (int)images.size();
+
+        int threads = std::min((int)images.size(), std::max(1, (int)std::thread::hardware_concurrency()));
+        for (int i = 0; i < threads; i++)
+        {
+            workers.emplace_back(decodeImages);
+        }
+    }
+
+    bool decoded()
+    {
+        return loadingStarted && imagesDecoded.load() == imageCount;
+    }
+
+    bool buildAtlas()
+    {
+        if (atlasBuilt)
+        {
+            return packedSize.x > 0;
+        }
+        atlasBuilt = true;
+
+        // only waits if pieces are asked for before the workers are done
+        startLoading();
+        stopLoading();
+        images.erase(std::remove_if(images.begin(), images.end(), [](const Image &image) {
+            if (image.pixels == NULL)
+            {
+                std::cout << "Failed to load texture: " << resourcePath(image.name) << std::endl;
+            }
+            return image.pixels == NULL;
+        }), images.end());
+        if (images.empty())
+        {
+            return false;
+        }
+
+        std::vector<stbrp_rect> rects(images.size());
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            rects[i].id = (int)i;
+            rects[i].w = images[i].width + 2 * kPadding;
+            rects[i].h = images[i].height + 2 * kPadding;
+        }
+        int side = kMinAtlasSide;
+        bool packed = false;
+        for (; side <= kMaxAtlasSide && !packed; side *= 2)
+        {
+            std::vector<stbrp_node> nodes(side);
+            stbrp_context context;
+            stbrp_init_target(&context, side, side, nodes.data(), (int)nodes.size());
+            packed = stbrp_pack_rects(&context, rects.data(), (int)rects.size()) == 1;
+        }
+        side /= 2;
+
+        if (packed)
+        {
+            std::vector<unsigned char> atlas((size_t)side * side * 4, 0);
+            for (const stbrp_rect &rect : rects)
+            {
+                blit(atlas, side, images[rect.id], rect.x + kPadding, rect.y + kPadding);
+            }
+            ImTextureID texture = Sprite::uploadTexture(atlas.data(), side, side);
+            if (texture != 0)
+            {
+                for (const stbrp_rect &rect : rects)
+                {
+                    const Image &image = images[rect.id];
+                    Texture &entry = textures[image.name];
+                    entry.texture = texture;
+                    entry.uv0 = ImVec2((float)(rect.x + kPadding) / side, (float)(rect.y + kPadding) / side);
+                    entry.uv1 = ImVec2((float)(rect.x + kPadding + image.width) / side, (float)(rect.y + kPadding + image.height) / side);
+                    entry.size = ImVec2((float)image.width, (float)image.height);
+                }
+                packedSize = ImVec2((float)side, (float)side);
+            }
+            else
+            {
+                packed = false;
+            }
+        }
+        else
+        {
+            std::cout << "Resources don't fit in a " << kMaxAtlasSide << " pixel atlas, loading them one by one" << std::endl;
+        }
+
+        for (Image &image : images)
+        {
+            stbi_image_free(image.pixels);
+        }
+        images.clear();
+        return packed;
+    }
+
+    void stopLoading()
+    {
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    const Texture *find(const char *name)
+    {
+        buildAtlas();
+        auto found = textures.find(name);
+        if (found != textures.end())
+        {
+            return found->second.texture != 0 ? &found->second : nullptr;
+        }
+
+        // not part of the atlas, load it as a texture of its own. a failure is remembered too so it's only reported once
+        Texture &entry = textures[name];
+        std::string path = resourcePath(name);
+        int width = 0;
+        int height = 0;
+        unsigned char *pixels = stbi_load(path.c_str(), &width, &height, NULL, 4);
+        if (pixels == NULL)
+        {
+            std::cout << "Failed to load texture: " << path << std::endl;
+            return nullptr;
+        }
+        entry.texture = Sprite::uploadTexture(pixels, width, height);
+        entry.size = ImVec2((float)width, (float)height);
+        stbi_image_free(pixels);
+        return entry.texture != 0 ? &entry : nullptr;
+    }
+
+    ImVec2 atlasSize()
+    {
+        return packedSize;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../imgui/imgui.h"
+
+//
+// process-wide textures, keyed by the resource file name ("x.png")
+// startLoading() decodes every png in resources/ on worker threads while the app starts up, and buildAtlas() packs
+// them into a single texture and uploads it in one go. after that creating a piece is a table lookup that never
+// reads the disk or uploads anything, and every sprite shares one texture that dear imgui can draw in a single
+// command. a name that isn't in the atlas is loaded on its own the first time it's asked for and kept from then on.
+//
+namespace TextureCache
+{
+    struct Texture
+    {
+        ImTextureID texture = 0;
+        // where the image sits in the texture
+        ImVec2      uv0 = ImVec2(0, 0);
+        ImVec2      uv1 = ImVec2(1, 1);
+        // the size of the image in pixels
+        ImVec2      size = ImVec2(0, 0);
+    };
+
+    // returns straight away, the decoding happens on other threads
+    void startLoading();
+    // every file has been decoded, so buildAtlas() won't have to wait
+    bool decoded();
+    // needs the graphics backend up and runs on the render thread. find() builds it on first use if nobody has yet
+    bool buildAtlas();
+    // waits for any decoding still going, before the app exits
+    void stopLoading();
+    // nullptr when the file can't be loaded
+    const Texture *find(const char *name);
+
+    // the packed texture's size in pixels, zero until it's built
+    ImVec2 atlasSize();
+}
@@ -1,9 +1,23 @@
 #include "TicTacToe.h"
 
+// the board is sized to fit in about this many pixels, small boards keep the full size squares
+static const float kBoardPixels = 640.0f;
+static const float kFullSquareSize = 80.0f;
 
-TicTacToe::TicTacToe()
+// the AI thinks in slices that fit in a frame so the window keeps drawing on large boards,
+// and plays the deepest result once it has thought for kThinkingMs in total
+static const int kFrameSliceMs = 12;
+static const int kThinkingMs = 600;
+
+// limits for the threat-space search tried before every AI move
+static const int kFourChainDepth = 16;
+static const int kFourChainNodes = 20000;
+
+TicTacToe::TicTacToe(int width, int height, int inARow) : _board(width, height, inARow), _search(1 << 16)
 {
-    _grid = new Grid(3, 3);
+    _grid = new Grid(_board.width(), _board.height());
+    _squareSize = std::min(kFullSquareSize, kBoardPixels / std::max(_board.width(), _board.height()));
+    _thinkingMs = 0;
 }
 
 TicTacToe::~TicTacToe()
@@ -17,9 +31,10 @@ TicTacToe::~TicTacToe()
 Bit* TicTacToe::PieceForPlayer(const int playerNumber)
 {
     // depending on playerNumber load the "x.png" or the "o.png" graphic
-    Bit *bit = new Bit();
+    Bit *bit = _bitPool.acquire();
     // should possibly be cached from player class?
     bit->LoadTextureFromFile(playerNumber == AI_PLAYER ? "o.png" : "x.png");
+    bit->setSize(_squareSize, _squareSize);
     bit->setOwner(getPlayerAt(playerNumber == AI_PLAYER ? 1 : 0));
     return bit;
 }
@@ -27,9 +42,9 @@ Bit* TicTacToe::PieceForPlayer(const int playerNumber)
 void TicTacToe::setUpBoard()
 {
     setNumberOfPlayers(2);
-    _gameOptions.rowX = 3;
-    _gameOptions.rowY = 3;
-    _grid->initializeSquares(80, "square.png");
+    _gameOptions.rowX = _board.width();
+    _gameOptions.rowY = _board.height();
+    _grid->initializeSquares(_squareSize, "square.png");
 
     if (gameHasAI()) {
         setAIPlayer(AI_PLAYER);
@@ -43,16 +58,18 @@ void TicTacToe::setUpBoard()
 //
 bool TicTacToe::actionForEmptyHolder(BitHolder &holder)
 {
-    if (holder.bit()) {
+    if (holder.bit() || _board.winner() >= 0) {
         return false;
     }
     Bit *bit = PieceForPlayer(getCurrentPlayer()->playerNumber() == 0 ? HUMAN_PLAYER : AI_PLAYER);
     if (bit) {
+        ChessSquare* square = static_cast<ChessSquare*>(&holder);
+        _board.place(_grid->getIndex(square->getColumn(), square->getRow()), getCurrentPlayer()->playerNumber());
         bit->setPosition(holder.getPosition());
         holder.setBit(bit);
         endTurn();
         return true;
-    }   
+    }
     return false;
 }
 
@@ -76,44 +93,19 @@ void TicTacToe::stopGame()
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
-}
-
-//
-// helper function for the winner check
-//
-Player* TicTacToe::ownerAt(int index ) const
-{
-    auto square = _grid->getSquare(index % 3, index / 3);
-    if (!square || !square->bit()) {
-        return nullptr;
-    }
-    return square->bit()->getOwner();
+    _board = MNKBoard(_board.width(), _board.height(), _board.inARow());
+    _thinking = SearchResult<int>();
+    _thinkingMs = 0;
 }
 
 Player* TicTacToe::checkForWinner()
 {
-    static const int kWinningTriples[8][3] =  { {0,1,2}, {3,4,5}, {6,7,8},  // rows
-                                                {0,3,6}, {1,4,7}, {2,5,8},  // cols
-                                                {0,4,8}, {2,4,6} };         // diagonals
-    for( int i=0; i<8; i++ ) {
-        const int *triple = kWinningTriples[i];
-        Player *player = ownerAt(triple[0]);
-        if( player && player == ownerAt(triple[1]) && player == ownerAt(triple[2]) )
-            return player;
-    }
-    return nullptr;
+    return _board.winner() >= 0 ? getPlayerAt(_board.winner()) : nullptr;
 }
 
 bool TicTacToe::checkForDraw()
 {
-    bool isDraw = true;
-    // check to see if the board is full
-    _grid->forEachSquare([&isDraw](ChessSquare* square, int x, int y) {
-        if (!square->bit()) {
-            isDraw = false;
-        }
-    });
-    return isDraw;
+    return _board.winner() < 0 && _board.full();
 }
 
 //
@@ -121,22 +113,19 @@ bool TicTacToe::checkForDraw()
 //
 std::string TicTacToe::initialStateString()
 {
-    return "000000000";
+    return std::string(_board.cells(), '0');
 }
 
 //
 // this still needs to be tied into imguis init and shutdown
-// we will read the state string and store it in each turn object
+// the move log diffs it against the last one at the end of each turn
 //
 std::string TicTacToe::stateString()
 {
-    std::string s = "000000000";
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit *bit = square->bit();
-        if (bit) {
-            s[y * 3 + x] = std::to_string(bit->getOwner()->playerNumber()+1)[0];
-        }
-    });
+    std::string s(_board.cells(), '0');
+    for (int cell = 0; cell < _board.cells(); cell++) {
+        s[cell] = (char)('0' + _board.stoneAt(cell) + 1);
+    }
     return s;
 }
 
@@ -146,102 +135,66 @@ std::string TicTacToe::stateString()
 //
 void TicTacToe::setStateString(const std::string &s)
 {
+    if ((int)s.length() != _board.cells()) return;
+
+    boardChanged();
+    _board = MNKBoard(_board.width(), _board.height(), _board.inARow());
+    _thinking = SearchResult<int>();
+    _thinkingMs = 0;
     _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y*3 + x;
+        square->destroyBit();
+        int index = _grid->getIndex(x, y);
         int playerNumber = s[index] - '0';
-        if (playerNumber) {
-            square->setBit( PieceForPlayer(playerNumber-1) );
-        } else {
-            square->setBit( nullptr );
+        if (playerNumber == 1 || playerNumber == 2) {
+            _board.place(index, playerNumber - 1);
+            Bit *bit = PieceForPlayer(playerNumber - 1);
+            bit->setPosition(square->getPosition());
+            square->setBit(bit);
         }
     });
 }
 
+void TicTacToe::playAIMove(int cell)
+{
+    _thinking = SearchResult<int>();
+    _thinkingMs = 0;
+    actionForEmptyHolder(*_grid->getSquareByIndex(cell));
+}
 
 //
-// this is the function that will be called by the AI
+// this is the function that will be called by the AI, once per frame while it is the AI's turn
 //
-void TicTacToe::updateAI() 
+void TicTacToe::updateAI()
 {
-    int bestVal = -1000;
-    BitHolder* bestMove = nullptr;
-    std::string state = stateString();
-
-    // Traverse all cells, evaluate minimax function for all empty cells
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y * 3 + x;
-        // Check if cell is empty
-        if (state[index] == '0') {
-            // Make the move
-            state[index] = '2';
-            int moveVal = -negamax(state, 0, HUMAN_PLAYER);
-            // Undo the move
-            state[index] = '0';
-            // If the value of the current move is more than the best value, update best
-            if (moveVal > bestVal) {
-                bestMove = square;
-                bestVal = moveVal;
-            }
-        }
-    });
-
-
-    // Make the best move
-    if(bestMove) {
-        if (actionForEmptyHolder(*bestMove)) {
-        }
+    if (_board.winner() >= 0 || _board.full()) {
+        return;
     }
-}
-
-bool isAIBoardFull(const std::string& state) {
-    return state.find('0') == std::string::npos;
-}
 
-int evaluateAIBoard(const std::string& state) {
-    static const int kWinningTriples[8][3] =  { {0,1,2}, {3,4,5}, {6,7,8},  // rows
-                                                {0,3,6}, {1,4,7}, {2,5,8},  // cols
-                                                {0,4,8}, {2,4,6} };         // diagonals
-    for( int i=0; i<8; i++ ) {
-        const int *triple = kWinningTriples[i];
-        char first = state[triple[0]];
-        if( first != '0' && first == state[triple[1]] && first == state[triple[2]] ) {
-            return 10;   // someone won, negamax will handle who
+    // a chain of fours wins by force and is found long before the search would see it
+    if (!_thinking.hasMove) {
+        int move;
+        if (_board.findForcedWin(kFourChainDepth, kFourChainNodes, move)) {
+            playAIMove(move);
+            return;
         }
     }
-    return 0; // No winner
-}
-
-//
-// player is the current player's number (AI or human)
-//
-int TicTacToe::negamax(std::string& state, int depth, int playerColor) 
-{
-    int score = evaluateAIBoard(state);
 
-    // Check if AI wins, human wins, or draw
-    if(score) { 
-        // A winning state is a loss for the player whose turn it is.
-        // The previous player made the winning move.
-        return -score; 
+    // the table carries over between slices, so each one gets deeper than the last
+    SearchLimits limits;
+    limits.maxDepth = _board.cells() - _board.stones();
+    limits.timeMs = kFrameSliceMs;
+    auto start = std::chrono::steady_clock::now();
+    auto result = _search.run(_board, limits);
+    _thinkingMs += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    if (!result.hasMove) {
+        return;
     }
 
-    if(isAIBoardFull(state)) {
-        return 0; // Draw
+    bool decided = result.score >= SearchScore::kWinThreshold || result.score <= -SearchScore::kWinThreshold;
+    if (decided || result.depth >= _thinking.depth) {
+        _thinking = result;
     }
-
-    int bestVal = -1000; // Min value
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            // Check if cell is empty
-            if (state[y * 3 + x] == '0') {
-                // Make the move
-                state[y * 3 + x] = playerColor == HUMAN_PLAYER ? '1' : '2'; // Set the cell to the current player's color
-                bestVal = std::max(bestVal, -negamax(state, depth + 1, -playerColor));
-                // Undo the move for backtracking
-                state[y * 3 + x] = '0';
-            }
-        }
+    if (decided || result.depth >= limits.maxDepth || _thinkingMs >= kThinkingMs) {
+        playAIMove(_thinking.bestMove);
     }
-
-    return bestVal;
-}
\ No newline at end of file
+}
@@ -1,8 +1,11 @@
 #pragma once
 #include "Game.h"
+#include "MNKBoard.h"
+#include "Search.h"
 
 //
-// the classic game of tic tac toe
+// the classic game of tic tac toe, and its bigger m,n,k relatives such as gomoku:
+// the first to get inARow stones in a line on a width x height board wins
 //
 
 //
@@ -11,7 +14,7 @@
 class TicTacToe : public Game
 {
 public:
-    TicTacToe();
+    TicTacToe(int width = 3, int height = 3, int inARow = 3);
     ~TicTacToe();
 
     // set up the board
@@ -32,9 +35,15 @@ public:
     Grid* getGrid() override { return _grid; }
 private:
     Bit *       PieceForPlayer(const int playerNumber);
-    Player*     ownerAt(int index ) const;
-    int         negamax(std::string& state, int depth, int playerColor);
+    void        playAIMove(int cell);
 
     Grid*       _grid;
-};
+    float       _squareSize;
+    // the rules, the grid only shows them
+    MNKBoard    _board;
+    Search<MNKSearchTraits> _search;
 
+    // large boards think a frame at a time, the deepest result so far and how long it took
+    SearchResult<int> _thinking;
+    int64_t     _thinkingMs;
+};
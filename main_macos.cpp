@@ -30,6 +30,9 @@
 #include "../libs/emscripten/emscripten_mainloop_stub.h"
 #endif
 
+// While idle the loop still wakes this often, for anything imgui animates on its own like the text cursor
+static const double kIdleWaitSeconds = 0.5;
+
 static void glfw_error_callback(int error, const char* description)
 {
     fprintf(stderr, "GLFW Error %d: %s\n", error, description);
@@ -137,7 +140,16 @@ int main(int, char**)
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
+        // When nothing on the board is moving, sleep until there's input instead of redrawing the same frame.
+        // The browser drives the Emscripten loop and can't be blocked, so it always polls.
+#ifdef __EMSCRIPTEN__
         glfwPollEvents();
+#else
+        if (ClassGame::IdleUntilInput())
+            glfwWaitEventsTimeout(kIdleWaitSeconds);
+        else
+            glfwPollEvents();
+#endif
 
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -171,6 +183,7 @@ int main(int, char**)
 #ifdef __EMSCRIPTEN__
     EMSCRIPTEN_MAINLOOP_END;
 #endif
+    ClassGame::GameShutDown();
 
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
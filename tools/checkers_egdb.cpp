@@ -0,0 +1,420 @@
+#include "../classes/CheckersEndgameDB.h"
+#include "../classes/Bitboard.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// builds the checkers endgame database by retrograde analysis
+// usage: checkers_egdb [--pieces 6] [--threads N] [--out resources/checkers_endgame.db]
+//
+// slices are solved from the fewest pieces up, and for the same number of pieces from the fewest men up,
+// so captures and crownings always lead into slices that are already finished. the only moves that stay
+// inside the counts being solved are plain steps, and those go back and forth between a slice and its
+// color swapped twin, so the two are solved together:
+//   1. every position is evaluated once from its moves, anything decided by the finished slices is settled
+//   2. each newly settled position unmoves into its predecessors, which are evaluated again
+//   3. when nothing new settles the rest are draws
+// both passes split the work over all threads, values are single bytes written with relaxed atomics.
+// a value is only ever written once it is proven, so the order the threads see them in does not matter.
+//
+
+using Value = CheckersEndgameDB::Value;
+using SliceKey = CheckersEndgameDB::SliceKey;
+
+struct Slice
+{
+    SliceKey key;
+    uint64_t positions = 0;
+    // 2 bit values once finished
+    std::vector<uint8_t> packed;
+    // one value per position while the slice is being solved
+    std::unique_ptr<std::atomic<uint8_t>[]> working;
+};
+
+// a settled position waiting to hand its value to its predecessors
+struct Settled
+{
+    int slice;
+    uint64_t index;
+};
+
+class Generator
+{
+public:
+    Generator(int maxPieces, int threads) : _maxPieces(maxPieces), _threads(threads)
+    {
+        _slotOf.assign(slotCount(), -1);
+    }
+
+    void run();
+    bool write(const std::string &path) const;
+
+private:
+    static constexpr int kSlotBase = CheckersEndgameDB::kMaxPieces + 1;
+    static int slotCount() { return kSlotBase * kSlotBase * kSlotBase * kSlotBase; }
+    static int slot(const SliceKey &key)
+    {
+        return ((key.redMen * kSlotBase + key.redKings) * kSlotBase + key.yellowMen) * kSlotBase + key.yellowKings;
+    }
+
+    Value lookup(const CheckersBoard &position) const;
+    Value evaluate(const CheckersBoard &position) const;
+    void  settle(int slice, uint64_t index, Value value, std::vector<Settled> &settled);
+    void  unmove(const Settled &from, std::vector<Settled> &settled);
+    void  solveGroup(const std::vector<int> &group);
+
+    template <typename Work>
+    void parallelFor(uint64_t count, uint64_t chunk, Work work);
+
+    int _maxPieces;
+    int _threads;
+    std::vector<Slice> _slices;
+    std::vector<int> _slotOf;
+};
+
+// a canonical position, red to move
+Value Generator::lookup(const CheckersBoard &position) const
+{
+    if (!position.red)
+    {
+        return CheckersEndgameDB::Loss;
+    }
+    if (!position.yellow)
+    {
+        return CheckersEndgameDB::Win;
+    }
+    const Slice &slice = _slices[_slotOf[slot(CheckersEndgameDB::sliceKeyOf(position))]];
+    uint64_t index = CheckersEndgameDB::indexOf(position);
+    if (slice.working)
+    {
+        return (Value)slice.working[index].load(std::memory_order_relaxed);
+    }
+    return CheckersEndgameDB::readValue(slice.packed.data(), index);
+}
+
+// what the moves of a canonical position prove so far, Unknown until it is decided
+Value Generator::evaluate(const CheckersBoard &position) const
+{
+    CheckersMove moves[CheckersBoard::kMaxMoves];
+    int count = position.generateMoves(CheckersRed, moves);
+    bool allWins = true;
+    for (int i = 0; i < count; i++)
+    {
+        CheckersBoard child = position;
+        child.play(CheckersRed, moves[i]);
+        Value value = lookup(CheckersEndgameDB::canonical(child, CheckersYellow));
+        if (value == CheckersEndgameDB::Loss)
+        {
+            return CheckersEndgameDB::Win;
+        }
+        if (value != CheckersEndgameDB::Win)
+        {
+            allWins = false;
+        }
+    }
+    // no moves at all is a loss too
+    return allWins ? CheckersEndgameDB::Loss : CheckersEndgameDB::Unknown;
+}
+
+void Generator::settle(int slice, uint64_t index, Value value, std::vector<Settled> &settled)
+{
+    uint8_t expected = CheckersEndgameDB::Unknown;
+    if (_slices[slice].working[index].compare_exchange_strong(expected, (uint8_t)value, std::memory_order_relaxed))
+    {
+        settled.push_back({ slice, index });
+    }
+}
+
+//
+// the positions one plain step before a settled one. in the settled position red is to move, so yellow made the
+// step: a yellow man came up from one of the two squares below it, a yellow king from any empty neighbor.
+// a step that crowned a man came from a slice with one more man and is left to that slice.
+//
+void Generator::unmove(const Settled &from, std::vector<Settled> &settled)
+{
+    CheckersBoard position;
+    CheckersEndgameDB::boardAt(_slices[from.slice].key, from.index, position);
+    uint32_t open = position.empty();
+
+    for (uint32_t pieces = position.yellow; pieces; pieces &= pieces - 1)
+    {
+        uint32_t bit = pieces & (0u - pieces);
+        bool king = (position.kings & bit) != 0;
+        for (int direction = CheckersBoard::UpLeft; direction <= CheckersBoard::DownRight; direction++)
+        {
+            // a yellow man only moves up, so it came from below
+            if (!king && direction <= CheckersBoard::UpRight)
+            {
+                continue;
+            }
+            uint32_t before = CheckersBoard::step(bit, direction) & open;
+            if (!before)
+            {
+                continue;
+            }
+            CheckersBoard previous = position;
+            previous.yellow = (previous.yellow & ~bit) | before;
+            if (king)
+            {
+                previous.kings = (previous.kings & ~bit) | before;
+            }
+            // a plain step is only legal when there was nothing to capture
+            if (previous.canCapture(CheckersYellow))
+            {
+                continue;
+            }
+
+            CheckersBoard canonical = CheckersEndgameDB::canonical(previous, CheckersYellow);
+            int slice = _slotOf[slot(CheckersEndgameDB::sliceKeyOf(canonical))];
+            uint64_t index = CheckersEndgameDB::indexOf(canonical);
+            if (_slices[slice].working[index].load(std::memory_order_relaxed) != CheckersEndgameDB::Unknown)
+            {
+                continue;
+            }
+            Value value = evaluate(canonical);
+            if (value != CheckersEndgameDB::Unknown)
+            {
+                settle(slice, index, value, settled);
+            }
+        }
+    }
+}
+
+template <typename Work>
+void Generator::parallelFor(uint64_t count, uint64_t chunk, Work work)
+{
+    std::atomic<uint64_t> next(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < _threads; t++)
+    {
+        threads.emplace_back([&, t] {
+            for (;;)
+            {
+                uint64_t begin = next.fetch_add(chunk);
+                if (begin >= count)
+                {
+                    break;
+                }
+                work(t, begin, std::min(begin + chunk, count));
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void Generator::solveGroup(const std::vector<int> &group)
+{
+    for (int slice : group)
+    {
+        Slice &s = _slices[slice];
+        s.working.reset(new std::atomic<uint8_t>[s.positions]);
+        for (uint64_t i = 0; i < s.positions; i++)
+        {
+            s.working[i].store(CheckersEndgameDB::Unknown, std::memory_order_relaxed);
+        }
+    }
+
+    // the first pass, every position in the group
+    std::vector<std::vector<Settled>> settled(_threads);
+    for (int slice : group)
+    {
+        Slice &s = _slices[slice];
+        parallelFor(s.positions, 4096, [&](int thread, uint64_t begin, uint64_t end) {
+            CheckersBoard position;
+            for (uint64_t index = begin; index < end; index++)
+            {
+                if (!CheckersEndgameDB::boardAt(s.key, index, position))
+                {
+                    continue;
+                }
+                Value value = evaluate(position);
+                if (value != CheckersEndgameDB::Unknown)
+                {
+                    settle(slice, index, value, settled[thread]);
+                }
+            }
+        });
+    }
+
+    // then outwards from whatever settled last
+    for (;;)
+    {
+        std::vector<Settled> frontier;
+        for (auto &list : settled)
+        {
+            frontier.insert(frontier.end(), list.begin(), list.end());
+            list.clear();
+        }
+        if (frontier.empty())
+        {
+            break;
+        }
+        parallelFor(frontier.size(), 256, [&](int thread, uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++)
+            {
+                unmove(frontier[i], settled[thread]);
+            }
+        });
+    }
+
+    // whatever is left can't be forced either way, pack it up
+    for (int slice : group)
+    {
+        Slice &s = _slices[slice];
+        s.packed.assign((s.positions + 3) / 4, 0);
+        CheckersBoard position;
+        for (uint64_t index = 0; index < s.positions; index++)
+        {
+            uint8_t value = s.working[index].load(std::memory_order_relaxed);
+            if (value == CheckersEndgameDB::Unknown && CheckersEndgameDB::boardAt(s.key, index, position))
+            {
+                value = CheckersEndgameDB::Draw;
+            }
+            s.packed[index >> 2] |= (uint8_t)(value << ((index & 3) * 2));
+        }
+        s.working.reset();
+    }
+}
+
+void Generator::run()
+{
+    // every split of the pieces with at least one on each side, in solving order
+    for (int pieces = 2; pieces <= _maxPieces; pieces++)
+    {
+        for (int men = 0; men <= pieces; men++)
+        {
+            for (int redMen = 0; redMen <= men; redMen++)
+            {
+                for (int redKings = 0; redKings <= pieces - men; redKings++)
+                {
+                    SliceKey key = { redMen, redKings, men - redMen, pieces - men - redKings };
+                    if (key.redMen + key.redKings == 0 || key.yellowMen + key.yellowKings == 0)
+                    {
+                        continue;
+                    }
+                    Slice slice;
+                    slice.key = key;
+                    slice.positions = CheckersEndgameDB::sliceSize(key);
+                    _slotOf[slot(key)] = (int)_slices.size();
+                    _slices.push_back(std::move(slice));
+                }
+            }
+        }
+    }
+
+    std::vector<bool> solved(_slices.size(), false);
+    for (size_t i = 0; i < _slices.size(); i++)
+    {
+        if (solved[i])
+        {
+            continue;
+        }
+        const SliceKey &key = _slices[i].key;
+        SliceKey swapped = { key.yellowMen, key.yellowKings, key.redMen, key.redKings };
+        int twin = _slotOf[slot(swapped)];
+        std::vector<int> group = { (int)i };
+        if (twin != (int)i)
+        {
+            group.push_back(twin);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        solveGroup(group);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (int slice : group)
+        {
+            solved[slice] = true;
+            const SliceKey &k = _slices[slice].key;
+            printf("red %dm %dk  yellow %dm %dk  %12llu positions  %.1fs\n", k.redMen, k.redKings, k.yellowMen,
+                   k.yellowKings, (unsigned long long)_slices[slice].positions, seconds);
+        }
+        fflush(stdout);
+    }
+}
+
+bool Generator::write(const std::string &path) const
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        printf("can't write %s\n", path.c_str());
+        return false;
+    }
+
+    CheckersEndgameDB::FileHeader header;
+    memcpy(header.magic, "CKDB", 4);
+    header.version = CheckersEndgameDB::kVersion;
+    header.maxPieces = (uint32_t)_maxPieces;
+    header.sliceCount = (uint32_t)_slices.size();
+    fwrite(&header, sizeof(header), 1, file);
+
+    uint64_t offset = sizeof(header) + _slices.size() * sizeof(CheckersEndgameDB::FileSlice);
+    for (const Slice &slice : _slices)
+    {
+        CheckersEndgameDB::FileSlice entry;
+        entry.redMen = (uint8_t)slice.key.redMen;
+        entry.redKings = (uint8_t)slice.key.redKings;
+        entry.yellowMen = (uint8_t)slice.key.yellowMen;
+        entry.yellowKings = (uint8_t)slice.key.yellowKings;
+        entry.reserved = 0;
+        entry.offset = offset;
+        entry.positions = slice.positions;
+        fwrite(&entry, sizeof(entry), 1, file);
+        offset += slice.packed.size();
+    }
+    for (const Slice &slice : _slices)
+    {
+        fwrite(slice.packed.data(), 1, slice.packed.size(), file);
+    }
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok)
+    {
+        printf("error writing %s\n", path.c_str());
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int pieces = 6;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::string outPath = "resources/checkers_endgame.db";
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--pieces") && hasValue)
+            pieces = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && hasValue)
+            threads = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--out") && hasValue)
+            outPath = argv[++i];
+        else
+        {
+            printf("usage: checkers_egdb [--pieces n] [--threads n] [--out file]\n");
+            return 1;
+        }
+    }
+    if (pieces < 2 || pieces > CheckersEndgameDB::kMaxPieces)
+    {
+        printf("--pieces must be between 2 and %d\n", CheckersEndgameDB::kMaxPieces);
+        return 1;
+    }
+
+    printf("building the %d piece database on %d threads\n", pieces, threads);
+    Generator generator(pieces, threads);
+    generator.run();
+    return generator.write(outPath) ? 0 : 1;
+}
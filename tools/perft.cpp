@@ -0,0 +1,294 @@
+#include "../classes/ChessBoard.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// counts the legal chess move tree to a fixed depth, to check ChessBoard's move generator
+// usage: perft [--depth 5] [--threads N] [--hash 256] [--fen placement] [--black] [--divide] [--expect n]
+//
+// ChessBoard's moves are pseudo legal, the AI just lets a king be taken. here a move that leaves the mover's
+// king where the other side can take it is dropped, so the totals are comparable with the standard tables as
+// long as castling, en passant and promotion don't come up: from the start position that's up to depth 4
+// (20, 400, 8902, 197281). --expect exits non zero when the total is anything else.
+//
+// root moves are shared out between the threads, and subtree counts are cached in one table all of them use,
+// keyed by the position's zobrist key and the depth left. an entry is two 64 bit words written with relaxed
+// atomics, the check word is the key xor the data word, so an entry torn by two threads writing it at once just
+// fails the check and is counted again
+//
+
+static const char *kStartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR";
+
+class PerftTable
+{
+public:
+    explicit PerftTable(size_t megabytes)
+    {
+        size_t entries = megabytes * 1024 * 1024 / sizeof(Entry);
+        size_t size = 1;
+        while (size * 2 <= entries)
+        {
+            size *= 2;
+        }
+        if (entries > 0)
+        {
+            _entries.reset(new Entry[size]);
+            _mask = size - 1;
+        }
+    }
+
+    bool probe(uint64_t key, int depth, uint64_t &count) const
+    {
+        if (!_entries)
+        {
+            return false;
+        }
+        const Entry &entry = _entries[slot(key, depth)];
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || (int)(data & 0xFF) != depth)
+        {
+            return false;
+        }
+        count = data >> 8;
+        return true;
+    }
+
+    void store(uint64_t key, int depth, uint64_t count)
+    {
+        if (!_entries)
+        {
+            return;
+        }
+        // counts up to 2^56 fit next to the depth
+        uint64_t data = (count << 8) | (uint64_t)depth;
+        Entry &entry = _entries[slot(key, depth)];
+        entry.data.store(data, std::memory_order_relaxed);
+        entry.check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    // the same position at another depth goes somewhere else, so the two don't keep replacing each other
+    size_t slot(uint64_t key, int depth) const { return (key ^ zobristKey(0x7E000 + depth)) & _mask; }
+
+    std::unique_ptr<Entry[]> _entries;
+    size_t _mask = 0;
+};
+
+// after a move, whether the side now to move could take the king of the side that just moved
+static bool kingLeftEnPrise(const ChessPosition &position)
+{
+    char king = (position.color == 1) ? 'k' : 'K';
+    const char *square = (const char *)memchr(position.board, king, 64);
+    if (!square)
+    {
+        return false;
+    }
+    int kingSquare = (int)(square - position.board);
+    BitMove replies[ChessSearchTraits::kMaxMoves];
+    int count = ChessSearchTraits::generateMoves(position, replies);
+    for (int i = 0; i < count; i++)
+    {
+        if (replies[i].to == kingSquare)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t perft(ChessPosition &position, int depth, PerftTable &table)
+{
+    if (depth == 0)
+    {
+        return 1;
+    }
+    int terminalScore;
+    if (ChessSearchTraits::isTerminal(position, terminalScore))
+    {
+        return 0;
+    }
+    uint64_t nodes;
+    if (depth > 1 && table.probe(position.key, depth, nodes))
+    {
+        return nodes;
+    }
+    BitMove moves[ChessSearchTraits::kMaxMoves];
+    int count = ChessSearchTraits::generateMoves(position, moves);
+    nodes = 0;
+    for (int i = 0; i < count; i++)
+    {
+        ChessSearchTraits::Undo undo;
+        ChessSearchTraits::makeMove(position, moves[i], undo);
+        if (!kingLeftEnPrise(position))
+        {
+            nodes += (depth == 1) ? 1 : perft(position, depth - 1, table);
+        }
+        ChessSearchTraits::unmakeMove(position, moves[i], undo);
+    }
+    if (depth == 1)
+    {
+        return nodes;
+    }
+    table.store(position.key, depth, nodes);
+    return nodes;
+}
+
+// the piece placement field of a FEN string as the 64 character state, a1 first
+static bool stateFromFEN(const char *fen, std::string &state)
+{
+    state.assign(64, '0');
+    int row = 7;
+    int col = 0;
+    for (const char *c = fen; *c && *c != ' '; c++)
+    {
+        if (*c == '/')
+        {
+            row--;
+            col = 0;
+        }
+        else if (*c >= '1' && *c <= '8')
+        {
+            col += *c - '0';
+        }
+        else if (strchr("pnbrqkPNBRQK", *c) && row >= 0 && col < 8)
+        {
+            state[row * 8 + col] = *c;
+            col++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return row == 0;
+}
+
+static std::string squareName(int index)
+{
+    return { (char)('a' + index % 8), (char)('1' + index / 8) };
+}
+
+int main(int argc, char **argv)
+{
+    int depth = 5;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int hashMegabytes = 256;
+    const char *fen = kStartFEN;
+    int color = 1;
+    bool divide = false;
+    long long expect = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--depth") && hasValue)
+            depth = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && hasValue)
+            threads = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--hash") && hasValue)
+            hashMegabytes = std::max(0, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--fen") && hasValue)
+            fen = argv[++i];
+        else if (!strcmp(argv[i], "--black"))
+            color = -1;
+        else if (!strcmp(argv[i], "--divide"))
+            divide = true;
+        else if (!strcmp(argv[i], "--expect") && hasValue)
+            expect = atoll(argv[++i]);
+        else
+        {
+            printf("usage: perft [--depth n] [--threads n] [--hash mb] [--fen placement] [--black] [--divide] [--expect n]\n");
+            return 1;
+        }
+    }
+    std::string state;
+    if (!stateFromFEN(fen, state))
+    {
+        printf("can't read the placement field of %s\n", fen);
+        return 1;
+    }
+    if (depth < 1 || depth > 63)
+    {
+        printf("--depth must be between 1 and 63\n");
+        return 1;
+    }
+
+    ChessPosition root = ChessPosition::fromState(state, color);
+    BitMove rootMoves[ChessSearchTraits::kMaxMoves];
+    int terminalScore;
+    int rootCount = 0;
+    if (!ChessSearchTraits::isTerminal(root, terminalScore))
+    {
+        BitMove moves[ChessSearchTraits::kMaxMoves];
+        int count = ChessSearchTraits::generateMoves(root, moves);
+        for (int i = 0; i < count; i++)
+        {
+            ChessSearchTraits::Undo undo;
+            ChessSearchTraits::makeMove(root, moves[i], undo);
+            if (!kingLeftEnPrise(root))
+            {
+                rootMoves[rootCount++] = moves[i];
+            }
+            ChessSearchTraits::unmakeMove(root, moves[i], undo);
+        }
+    }
+    threads = std::min(threads, std::max(rootCount, 1));
+
+    printf("perft %d on %d threads with a %d MB table\n", depth, threads, hashMegabytes);
+    auto start = std::chrono::steady_clock::now();
+
+    // each thread takes the next root move, on its own copy of the position
+    PerftTable table(hashMegabytes);
+    std::vector<uint64_t> counts(rootCount, 0);
+    std::atomic<int> nextMove(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&] {
+            ChessPosition position = root;
+            for (int i = nextMove++; i < rootCount; i = nextMove++)
+            {
+                ChessSearchTraits::Undo undo;
+                ChessSearchTraits::makeMove(position, rootMoves[i], undo);
+                counts[i] = perft(position, depth - 1, table);
+                ChessSearchTraits::unmakeMove(position, rootMoves[i], undo);
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    uint64_t total = 0;
+    for (int i = 0; i < rootCount; i++)
+    {
+        if (divide)
+        {
+            printf("%s%s: %llu\n", squareName(rootMoves[i].from).c_str(), squareName(rootMoves[i].to).c_str(), (unsigned long long)counts[i]);
+        }
+        total += counts[i];
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("nodes %llu  %.2fs  %.1f Mnps\n", (unsigned long long)total, seconds, total / std::max(seconds, 1e-9) / 1e6);
+    if (expect >= 0 && total != (uint64_t)expect)
+    {
+        printf("expected %lld\n", expect);
+        return 1;
+    }
+    return 0;
+}